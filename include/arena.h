@@ -0,0 +1,43 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/*
+ *  Alocador por região: alocações são só avanços de ponteiro dentro de
+ *  blocos grandes, e tudo é liberado de uma vez por <arena_reset()>, que
+ *  mantém os blocos para a próxima rodada. Apenas a alocação mais recente
+ *  pode crescer no lugar (<arena_grow()>) ou ser devolvida (<arena_pop()>).
+ */
+
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t capacity;
+    size_t used;
+    unsigned char data[] __attribute__((aligned(16)));
+} arena_block;
+
+typedef struct {
+    arena_block *first;
+    arena_block *current;
+    size_t block_size;
+    void *last; /* alocação mais recente */
+} arena;
+
+void arena_init(arena *a, size_t block_size);
+void *arena_alloc(arena *a, size_t size);
+void *arena_grow(arena *a, void *p, size_t old_size, size_t new_size);
+void arena_pop(arena *a, void *p);
+void arena_reset(arena *a);
+void arena_free(arena *a);
+
+/*
+ *  Variantes que recorrem a <malloc()>/<realloc()>/<free()> quando <a> é
+ *  NULL, para funções usadas tanto dentro quanto fora de uma rodada.
+ */
+
+void *mem_alloc(arena *a, size_t size);
+void *mem_grow(arena *a, void *p, size_t old_size, size_t new_size);
+void mem_free(arena *a, void *p);
+
+#endif
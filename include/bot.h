@@ -0,0 +1,47 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <wchar.h>
+#include <arena.h>
+#include <dict.h>
+#include <rng.h>
+
+/*
+ *  Robôs que ocupam assentos vazios. As palavras do dicionário são
+ *  indexadas uma única vez por categoria e letra inicial (<bot_index>,
+ *  parte do pacote, ver <config.h>), de modo que a jogada de um robô é só
+ *  sortear algumas posições de uma faixa contígua: microssegundos, sem
+ *  alocações fora da região da rodada.
+ *
+ *  A resposta sai como texto digitado e segue o mesmo caminho das dos
+ *  jogadores humanos (<validate_answer()>, <check_answer()>). Como o
+ *  dicionário guarda as palavras normalizadas, os robôs as escrevem sem
+ *  acentos, com a inicial de cada palavra em maiúscula.
+ */
+
+#define BOT_LETTERS 26 /* A a Z, como os alfabetos dos pacotes */
+
+typedef struct {
+    double skill;   /* em [0, 1]: chance de saber uma palavra e preferência pelas longas */
+    double latency; /* segundos até responder, em média */
+} bot_profile;
+
+typedef struct {
+    int first; /* em <word> */
+    int count;
+} bot_list;
+
+typedef struct {
+    int categories;
+    bot_list *list; /* categories x BOT_LETTERS */
+    int *word;      /* início de cada palavra em <text> */
+    int words;
+    wchar_t *text;  /* palavras terminadas em '\0', na ordem do dicionário */
+    int text_size;
+} bot_index;
+
+bot_index *bot_index_build(const dictionary *dict, int categories, int max_length);
+void bot_index_free(bot_index *index);
+wchar_t *bot_answer(arena *a, rng *g, const bot_index *index, const bot_profile *bot, int category, wchar_t letter, double budget, double *latency);
+
+#endif
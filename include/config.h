@@ -0,0 +1,70 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <wchar.h>
+#include <arena.h>
+#include <dict.h>
+#include <bot.h>
+
+/*
+ *  Pacote de configuração das salas: alfabeto, categorias, número de
+ *  rodadas, curva de tempo e limites de tamanho. É lido de um arquivo (ou
+ *  do pacote embutido, com os valores de sempre) uma única vez e compilado
+ *  em tabelas imutáveis, numa só região, que as partidas referenciam sem
+ *  copiar. Junto vêm as tabelas derivadas: letras já normalizadas, maior
+ *  nome de categoria, o dicionário aberto para as categorias do pacote e
+ *  o índice de palavras dos robôs.
+ *
+ *  Cada partida segura uma referência (<config_retain()>); trocar o pacote
+ *  de um servidor em execução é só carregar outro e soltar o antigo, que é
+ *  liberado quando a última partida que o usa termina.
+ *
+ *  Formato do arquivo (UTF-8), uma chave por linha, '#' inicia comentário:
+ *
+ *      letras: ABCDEFGHIJLMNOPQRSTUVXZ
+ *      rodadas: 5
+ *      tempo: 8 2            (mínimo, em segundos, e acréscimo por jogador
+ *                             que ainda falta jogar na rodada)
+ *      nome: 12              (caracteres de um nome de jogador)
+ *      resposta: 30          (caracteres de uma resposta)
+ *      categoria: Cidades
+ *      categoria-nome: Pessoas   (só o primeiro nome da resposta conta)
+ *
+ *  Chaves omitidas ficam com o valor do pacote embutido; as categorias, se
+ *  houver alguma, substituem todas as embutidas. As rodadas não precisam
+ *  coincidir com o número de letras ou de categorias: as sequências são
+ *  sorteadas em blocos, sem repetição até se esgotarem.
+ */
+
+#define CONFIG_CATEGORIES 64
+#define CONFIG_LINE 512
+
+typedef struct {
+    int refs; /* referências, contadas atomicamente */
+
+    int name_size;
+    int answer_size;
+    int rounds;
+    double min_time;
+    double time_decrement;
+
+    int number_of_letters;
+    const wchar_t *letters;        /* como exibidas */
+    const wchar_t *folded_letters; /* <fold_char()> de cada letra */
+
+    int number_of_categories;
+    const wchar_t *categories[CONFIG_CATEGORIES];
+    unsigned char first_word[CONFIG_CATEGORIES]; /* só o primeiro nome conta */
+    int category_width;                          /* maior nome de categoria */
+
+    const dictionary *dictionary; /* NULL aceita qualquer palavra */
+    const bot_index *bots;        /* palavras do dicionário por categoria e letra; NULL sem dicionário */
+
+    arena tables; /* textos acima */
+} game_config;
+
+game_config *config_load(const char *path, const char *dict_path, int *error_line);
+game_config *config_retain(game_config *config);
+void config_release(game_config *config);
+
+#endif
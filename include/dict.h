@@ -0,0 +1,74 @@
+#ifndef DICT_H
+#define DICT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+#include <str8.h>
+
+/*
+ *  Dicionário de palavras válidas por categoria, guardado como um autômato
+ *  mínimo (DAWG): cada categoria tem uma raiz, e prefixos e sufixos comuns
+ *  são compartilhados, inclusive entre categorias. As palavras entram
+ *  normalizadas (<fold_char()>), e a busca percorre uma aresta por letra.
+ *
+ *  O autômato vive numa única imagem contígua, que pode ser gerada offline
+ *  por <dictc> e mapeada com <mmap()> (somente leitura, páginas
+ *  compartilhadas entre processos), ou montada em memória a partir das
+ *  listas em texto. Depois de aberto, o dicionário não é mais alterado,
+ *  podendo ser compartilhado por todas as salas do processo.
+ *
+ *  Formato da imagem (inteiros de 32 bits na ordem de bytes do host):
+ *
+ *      dict_header | dict_category[categories] | dict_edge[edges] | nomes
+ *
+ *  Os nós são sequências de arestas ordenadas por letra, a última marcada
+ *  com <DICT_LAST>; um nó é identificado pelo índice da sua primeira
+ *  aresta. A aresta 0 é sentinela, e o destino 0 indica nó sem arestas.
+ */
+
+#define DICT_MAGIC 0x47574144u  /* "DAWG" */
+#define DICT_VERSION 1
+#define DICT_NO_LIST 0xFFFFFFFFu /* categoria sem lista: aceita qualquer palavra */
+
+#define DICT_LABEL 0x001FFFFFu  /* caractere normalizado */
+#define DICT_FINAL 0x40000000u  /* alguma palavra termina nesta aresta */
+#define DICT_LAST 0x80000000u   /* última aresta do nó */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t categories;
+    uint32_t edges;
+    uint32_t names_size;
+} dict_header;
+
+typedef struct {
+    uint32_t root; /* primeira aresta da raiz; 0 se a lista for vazia */
+    uint32_t name; /* nome do arquivo da lista, sem ".txt", em <nomes> */
+} dict_category;
+
+typedef struct {
+    uint32_t label;  /* caractere | DICT_FINAL | DICT_LAST */
+    uint32_t target;
+} dict_edge;
+
+typedef struct {
+    void *image;
+    size_t size;
+    int mapped;            /* imagem de <mmap()> ou de <malloc()> */
+    const dict_edge *edge;
+    uint32_t edges;
+    int categories;        /* do jogo, não do arquivo */
+    uint32_t *root;        /* por categoria do jogo, ou DICT_NO_LIST */
+} dictionary;
+
+void *dict_compile(char *const *paths, int n, size_t *size);
+dictionary *dict_open(const char *path, const wchar_t *const *categories, int n);
+int dict_has_category(const dictionary *dict, int category);
+int dict_contains(const dictionary *dict, int category, const str8 *word);
+int dict_walk(const dictionary *dict, int category, int max_length,
+              int (*visit)(const wchar_t *word, int length, void *context), void *context);
+void dict_free(dictionary *dict);
+
+#endif
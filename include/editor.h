@@ -0,0 +1,27 @@
+#ifndef EDITOR_H
+#define EDITOR_H
+
+#include <wchar.h>
+#include <arena.h>
+#include <timer.h>
+#include <reader.h>
+
+/*
+ *  Editor de linha do terminal: com a entrada em modo cru (<termios> sem
+ *  ICANON nem ECHO), recebe as teclas uma a uma, mantém a resposta em
+ *  edição e redesenha só a linha do prompt (ver <render_line()>) quando o
+ *  relógio muda de décimo de segundo ou quando algo é digitado. Entre um
+ *  e outro, dorme em <await_input()>, de modo que o relógio não consome
+ *  CPU nem atrasa a leitura das teclas.
+ *
+ *  Teclas: caracteres imprimíveis, <Backspace>, <Ctrl-U> (apaga tudo),
+ *  <Enter>; sequências de escape (setas...) são ignoradas; <Ctrl-D> na
+ *  linha vazia encerra a entrada e <Ctrl-C> restaura o terminal antes de
+ *  interromper o processo.
+ */
+
+#define EDITOR_TICK (NSEC_PER_SEC / 10) /* resolução do relógio exibido */
+
+int editor_read(arena *a, line_reader *in, const wchar_t *prompt, const wchar_t *after, int limit, const nsec *deadline, wchar_t **line);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ *  Diário binário das partidas: cada rodada encerrada vira um registro
+ *  acrescentado ao fim do arquivo (O_APPEND), nunca reescrito, com letra,
+ *  categoria, ordem dos jogadores, respostas, tempo de cada turno e
+ *  escores. Os registros são acumulados em memória e gravados em lotes,
+ *  de modo que encerrar uma rodada não espera pelo disco.
+ *
+ *  Formato (inteiros na ordem de bytes do host, textos em UTF-8):
+ *
+ *      journal_header | registro | registro | ...
+ *
+ *      registro: journal_record | journal_turn[players] | textos | preenchimento
+ *
+ *  Os textos são o nome da categoria seguido de nome e resposta de cada
+ *  turno, na ordem em que jogaram, sem terminadores; o registro é
+ *  completado com zeros até um múltiplo de 8 bytes, e <size> leva ao
+ *  próximo. Um arquivo pode ser mapeado com <mmap()> e percorrido assim,
+ *  sem cópias (ver <journalq.c>).
+ */
+
+#define JOURNAL_MAGIC 0x524A4353u /* "SCJR" */
+#define JOURNAL_VERSION 2
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+} journal_header;
+
+typedef struct {
+    uint32_t size;          /* bytes do registro, múltiplo de 8 */
+    uint16_t players;
+    uint16_t round;         /* a partir de 0 */
+    uint64_t game;          /* identificador da partida */
+    uint64_t seed;          /* semente da partida: repete letras, categorias e ordens */
+    int64_t time;           /* fim da rodada, em ns desde a época */
+    uint32_t letter;        /* código Unicode */
+    uint16_t category;      /* índice na lista de categorias do jogo */
+    uint16_t category_size; /* bytes do nome da categoria */
+} journal_record;
+
+typedef struct {
+    int64_t time;         /* ns gastos no turno */
+    int32_t score;
+    uint32_t player;      /* índice do jogador na partida */
+    uint32_t name_size;   /* bytes */
+    uint32_t answer_size; /* bytes; 0 se não respondeu */
+} journal_turn;
+
+/*
+ *  Escrita, usada pelo jogo: <journal_round()>, que recebe a rodada de um
+ *  <game_data>, está em <main.h>.
+ */
+
+typedef struct {
+    int fd;
+    char *buffer; /* registros completos ainda não gravados */
+    size_t used;
+    size_t capacity;
+    uint64_t games; /* partidas iniciadas por este processo */
+} journal;
+
+journal *journal_open(const char *path);
+uint64_t journal_new_game(journal *j);
+int journal_flush(journal *j);
+int journal_close(journal *j);
+
+#endif
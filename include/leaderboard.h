@@ -0,0 +1,100 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+#include <treap.h>
+
+/*
+ *  Ranking geral: estatísticas acumuladas de cada jogador, identificado
+ *  pelo nome (sem distinção de caixa nem acentos), ao longo de todas as
+ *  partidas jogadas com o mesmo arquivo. A ordem é por vitórias, depois
+ *  pontos, depois menos partidas; empates ficam com quem chegou antes.
+ *
+ *  Os registros ficam todos em memória, com uma tabela de dispersão por
+ *  nome e uma treap de estatística de ordem (<treap.h>) ordenada pelo
+ *  ranking: posição de um jogador e os K primeiros saem em O(log n) e
+ *  O(log n + K). Encerrar uma partida só atualiza a memória e marca os
+ *  registros alterados, gravados depois de uma vez, no lugar, em
+ *  <leaderboard_flush()>.
+ *
+ *  Formato (inteiros na ordem de bytes do host, textos em UTF-8):
+ *
+ *      leaderboard_header | player_stats | player_stats | ...
+ */
+
+#define LEADERBOARD_MAGIC 0x4B4E5253u /* "SRNK" */
+#define LEADERBOARD_VERSION 1
+#define LEADERBOARD_NAME 64       /* bytes de um nome, com o '\0' */
+#define LEADERBOARD_CATEGORIES 16 /* categorias distintas acompanhadas */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t categories; /* em uso em <category> */
+    uint32_t reserved;
+    char category[LEADERBOARD_CATEGORIES][LEADERBOARD_NAME];
+} leaderboard_header;
+
+typedef struct {
+    uint32_t rounds;
+    uint32_t hits;  /* rodadas com pontos */
+    int64_t points;
+} category_stats;
+
+typedef struct {
+    char name[LEADERBOARD_NAME]; /* como escrito na primeira partida */
+    char key[LEADERBOARD_NAME];  /* nome sem caixa nem acentos */
+    uint32_t games;
+    uint32_t wins;
+    int64_t points;
+    uint64_t turns;
+    int64_t time; /* ns gastos em <turns> turnos */
+    category_stats category[LEADERBOARD_CATEGORIES];
+} player_stats;
+
+typedef struct {
+    int64_t points; /* cópias de <player_stats>, para a ordem do ranking */
+    uint32_t wins;
+    uint32_t games;
+} rank_node;
+
+typedef struct {
+    uint32_t hash; /* de <key>: só um registro lido por busca */
+    int player;    /* índice + 1, 0 se vazia */
+} name_slot;
+
+typedef struct {
+    int fd;
+    leaderboard_header header;
+    int header_dirty;
+
+    player_stats *players;
+    int count;
+    int capacity;
+
+    name_slot *slot; /* tabela de dispersão por <key> */
+    int slots;
+
+    rank_node *node; /* chaves da ordem, paralelas a <players> */
+    treap order;     /* sobre os índices de <players> */
+
+    int *dirty; /* índices a gravar */
+    int dirty_count;
+    unsigned char *is_dirty;
+} leaderboard;
+
+/*
+ *  Atualização, feita pelo jogo: <leaderboard_game()>, que recebe o
+ *  <game_data> encerrado, está em <main.h>.
+ */
+
+leaderboard *leaderboard_open(const char *path);
+int leaderboard_find(const leaderboard *lb, const wchar_t *name);
+int leaderboard_rank(const leaderboard *lb, int player);
+int leaderboard_top(const leaderboard *lb, int k, int *out);
+int leaderboard_flush(leaderboard *lb);
+int leaderboard_close(leaderboard *lb);
+
+#endif
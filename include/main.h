@@ -1,46 +1,121 @@
+#ifndef MAIN_H
+#define MAIN_H
+
+#include <stdio.h>
+#include <stdarg.h>
 #include <wchar.h>
-#include <sys/time.h>
+#include <timer.h>
+#include <score.h>
+#include <arena.h>
+#include <wstr.h>
+#include <str8.h>
+#include <render.h>
+#include <scoreboard.h>
+#include <dict.h>
+#include <journal.h>
+#include <leaderboard.h>
+#include <config.h>
+#include <standings.h>
+#include <rng.h>
 
-#define putws(s) wprintf(L"%S\n", s)
+#define putws(s) fwprintf(screen, L"%S\n", s)
 #define trunc(n) ((long long) (n))
 #define round(n) (trunc(n) + ((n) - trunc(n) < .5? 0: 1))
 #define abs(n) ((n >= 0)? n: -n)
-#define clear() system("clear")
-#define newline() putwchar(L'\n');
+#define clear() render_clear()
+#define newline() putwc(L'\n', screen);
 
-const unsigned long WCHAR_SIZE = sizeof(wchar_t);
+#define MAX_PLAYERS 10000 /* por sala; acima de SCOREBOARD_TOP, só os primeiros são listados */
 
-typedef struct timeval time_data;
+typedef nsec time_data; /* prazo absoluto, em <timer_now()> */
 
 
 typedef struct {
+    game_config *config; /* compartilhado e imutável; os campos constantes abaixo vêm dele */
     const int name_size;
     const int number_of_letters;
     const wchar_t *const letters;    /* pointer to constant character variable */
     const int rounds;
+    const int number_of_categories;
     const wchar_t *const *const categories;
     const double min_time;
     const double time_decrement;
     const int answer_size;
+    const dictionary *dictionary; /* compartilhado; NULL aceita qualquer palavra */
+    journal *journal;             /* compartilhado; NULL não registra as rodadas */
+    leaderboard *leaderboard;     /* compartilhado; NULL não acumula o ranking geral */
+    uint64_t game_id;
+    uint64_t seed; /* de <rng>, registrada no diário: a mesma semente repete a partida */
+    rng rng;       /* todos os sorteios da partida, inclusive os dos robôs */
 
-    int curr_round; 
+    int curr_round;
     int curr_turn;
     int number_of_players;
-    wchar_t **player_name;    
+    int bots;                 /* robôs nos últimos assentos, todos com <bot_profile> */
+    const bot_profile *bot_profile;
 
-    int *letters_sequence;
-    int *players_sequence;
+    int *letters_sequence;    /* estas três também ficam em <players_block> */
+    int *players_sequence;    /* reescrita no lugar a cada rodada, ver <draw_turn_order()> */
     int *categories_sequence;
-    
-    time_data curr_time_left;
 
-    wchar_t **round_answer;
-    int **score;
-    int *time_used;
+    time_data curr_time_left; /* prazo do turno atual */
+
+    /*
+     *  Estado dos jogadores em colunas (uma entrada por jogador), todas
+     *  num só bloco alocado em <init_game()>, cada coluna começando numa
+     *  linha de cache. Pontuar, desempatar e montar a tabela percorrem
+     *  memória contígua em vez de seguir um ponteiro por jogador.
+     */
+    void *players_block;
+    wchar_t *names;      /* nomes com passo <name_size> + 1, ver <player_name()> */
+    int *score;          /* jogadores x rodadas, linha a linha, ver <player_scores()> */
+    int *total;          /* soma de cada linha de <score> */
+    nsec *time_used;     /* tempo gasto por jogador, desempate de <victor()> */
+    nsec *turn_time;     /* tempo de cada jogador na rodada atual */
+    str8 **round_answer; /* em <round_arena> ou <no_answer>; nunca NULL depois do turno */
+    str8 *no_answer;     /* resposta vazia de quem não respondeu, alocada com a partida */
+
+    answer_tally tally;
+    standings standings; /* por <total>, atualizada em <score_round()> */
+    scoreboard board;
+    arena round_arena; /* respostas e prompts, liberados de uma vez após <show_answers()> */
 
 } game_data;
 
+static inline wchar_t *player_name(const game_data *data, int player)
+{
+    return data->names + player * (data->name_size + 1);
+}
+
+static inline int *player_scores(const game_data *data, int player)
+{
+    return data->score + player * data->rounds;
+}
+
 double time_left(time_data td);
 void set_time(time_data *td, double sec);
-wchar_t *vfwstring(const wchar_t *format, va_list ap);
-int starts_with(wchar_t *s, wchar_t l);
\ No newline at end of file
+wchar_t *read_line(arena *a, FILE *f);
+int validate_size(FILE *stream, int size_answer, unsigned long long min_size, unsigned long long max_size);
+int validate_answer(FILE *stream, arena *a, wchar_t *answer, unsigned long long min_size, unsigned long long max_size);
+void draw_turn_order(game_data *data);
+void seat_order(game_data *data);
+double player_total_time(game_data *data);
+void charge_turn(game_data *data, int player, nsec used);
+int check_answer(FILE *stream, game_data *data, str8 *answer);
+int is_bot(const game_data *data, int player);
+str8 *bot_turn(FILE *stream, game_data *data, double budget, double *latency);
+void show_players(FILE *stream, game_data *data);
+void show_answers(FILE *stream, game_data *data);
+void show_scores(FILE *stream, game_data *data);
+void show_standing(FILE *stream, game_data *data, int player);
+void show_ranking(FILE *stream, game_data *data);
+int victor(game_data *data);
+
+game_data new_game(game_config *config);
+int init_game(game_data *data, wchar_t *const *names);
+int score_round(game_data *data);
+int journal_round(journal *j, const game_data *data);
+int leaderboard_game(leaderboard *lb, const game_data *data, int winner);
+void free_game(game_data *data);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef POOL_H
+#define POOL_H
+
+/*
+ *  Laço paralelo com roubo de trabalho: <pool_run()> chama <task()> uma
+ *  vez para cada índice em [0, n), distribuídos entre <workers> threads (a
+ *  que chama é a de número 0). Cada thread começa com uma fatia contígua
+ *  de índices e a consome pela frente; ao esgotá-la, rouba a metade final
+ *  da fatia de outra. Uma fatia é um par (início, fim) num só inteiro de
+ *  64 bits, numa linha de cache própria, alterado com compare-and-swap:
+ *  sem travas, e sem tráfego entre núcleos enquanto ninguém precisa roubar.
+ *
+ *  As tarefas não devem depender da ordem nem da thread em que rodam; o
+ *  número da thread serve só para cada uma acumular seus resultados à
+ *  parte, a serem somados ao final.
+ */
+
+typedef void (*pool_task)(long index, int worker, void *context);
+
+int pool_cpus(void);
+int pool_run(int workers, long n, pool_task task, void *context);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <timer.h>
+
+/*
+ *  Medidas de latência por fase do turno. Cada fase tem um histograma
+ *  log-linear (à maneira do HdrHistogram): 32 faixas por potência de 2,
+ *  erro relativo de no máximo 1/32, de 1 ns a séculos, em contadores
+ *  fixos atualizados com operações atômicas relaxadas, sem travas, de
+ *  modo que qualquer thread registra e qualquer uma lê a qualquer
+ *  momento. Desligadas (o padrão), custam só um teste de <probe_enabled>.
+ *
+ *  <probe_report()> resume amostras, p50, p99, máximo e média de cada
+ *  fase; <probe_write()> grava o resumo num arquivo, trocado de uma vez
+ *  (ver <rename()>), para ser lido enquanto o jogo continua.
+ */
+
+enum {
+    PROBE_PROMPT, /* formatar o prompt do turno */
+    PROBE_WAIT,   /* esperar a entrada do jogador */
+    PROBE_DECODE, /* ler e decodificar a linha recebida */
+    PROBE_TRIM,   /* aparar espaços da resposta (<trim_wstring()>) */
+    PROBE_CLEAR,  /* limpar a tela */
+    PROBE_SCORE,  /* pontuar a rodada (<score_round()>) */
+    PROBE_TABLE,  /* montar a tabela de escores (<show_scores()>) */
+    PROBES
+};
+
+#define PROBE_SUB_BITS 5
+#define PROBE_BUCKETS ((64 - PROBE_SUB_BITS + 1) << PROBE_SUB_BITS)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum; /* ns */
+    uint64_t max;
+    uint64_t bucket[PROBE_BUCKETS];
+} __attribute__((aligned(64))) probe_histogram;
+
+extern int probe_enabled;
+
+void probe_record(int phase, nsec elapsed);
+void probe_report(FILE *stream);
+int probe_write(const char *path);
+
+static inline nsec probe_start(void)
+{
+    return probe_enabled? timer_now(): 0;
+}
+
+static inline void probe_end(int phase, nsec start)
+{ /* registra o tempo desde <start>, de <probe_start()> */
+    if (probe_enabled)
+        probe_record(phase, timer_now() - start);
+}
+
+#endif
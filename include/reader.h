@@ -0,0 +1,40 @@
+#ifndef READER_H
+#define READER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <wchar.h>
+
+/*
+ *  Leitor de linhas de tamanho fixo sobre um descritor: os bytes são lidos
+ *  em blocos para um anel e separados em linhas por <reader_next()>, que
+ *  guarda no máximo <limit> caracteres de cada uma e descarta o resto sem
+ *  copiá-lo. A memória por leitor é constante, qualquer que seja a entrada,
+ *  e uma linha enorme custa só a varredura pelo '\n'.
+ *
+ *  Não bloqueia por conta própria: <reader_fill()> faz uma única leitura,
+ *  que só espera se o descritor for bloqueante e não houver dados.
+ */
+
+#define READER_RING 4096 /* bytes lidos e ainda não separados em linhas */
+#define READER_LINE 256  /* bytes guardados por linha, no máximo */
+
+typedef struct {
+    int fd;
+    unsigned char ring[READER_RING];
+    size_t head, tail;      /* contadores livres: há <tail> - <head> bytes pendentes */
+    char line[READER_LINE]; /* linha em curso; terminada em '\0' quando completa */
+    size_t len;
+    int chars;              /* caracteres guardados em <line> */
+    int overflow;           /* linha excedeu o limite; o excedente foi descartado */
+    int complete;
+    int eof;
+} line_reader;
+
+void reader_init(line_reader *r, int fd);
+ssize_t reader_fill(line_reader *r);
+size_t reader_push(line_reader *r, const char *bytes, size_t n);
+int reader_next(line_reader *r, int limit);
+int reader_decode(const line_reader *r, wchar_t dst[READER_LINE]);
+
+#endif
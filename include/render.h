@@ -0,0 +1,32 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdio.h>
+#include <wchar.h>
+
+/*
+ *  Renderizador do terminal. O jogo escreve normalmente em <screen>, um
+ *  fluxo largo em memória; <render_present()> distribui esse texto num
+ *  quadro de células do tamanho do terminal, compara-o com o que já está
+ *  na tela e envia, num único <write()>, apenas as células alteradas
+ *  usando sequências de escape ANSI.
+ *
+ *  Se a saída não for um terminal, o texto é repassado sem escapes.
+ *
+ *  <render_line()> reescreve só a última linha, a que está sendo editada,
+ *  sem passar por <screen>: é o que redesenha o relógio a cada décimo de
+ *  segundo enquanto o jogador digita.
+ */
+
+extern FILE *screen;
+
+int render_init(void);
+void render_clear(void);
+void render_present(void);
+void render_echo(const wchar_t *line);
+int render_interactive(void);
+void render_line(const wchar_t *text);
+void render_line_end(void);
+void render_end(void);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/*
+ *  Gerador pseudoaleatório de cada partida: xoshiro256**, com o estado
+ *  inicial expandido da semente por splitmix64. Cada partida (sala do
+ *  servidor, jogo do terminal ou da simulação) tem o seu, sem estado
+ *  escondido compartilhado entre threads, e a mesma semente repete
+ *  exatamente os mesmos sorteios.
+ *
+ *  Os inteiros num intervalo saem sem viés (multiplicação com rejeição,
+ *  de Lemire); as permutações são geradas no lugar, num vetor já alocado,
+ *  sorteando duas posições por número de 64 bits sempre que possível.
+ */
+
+typedef struct {
+    uint64_t s[4];
+} rng;
+
+void rng_seed(rng *g, uint64_t seed);
+uint64_t rng_next(rng *g);
+uint32_t rng_below(rng *g, uint32_t bound);
+int rng_range(rng *g, int lower_bound, int upper_bound);
+double rng_unit(rng *g);
+void rng_permutation(rng *g, int *out, int n);
+uint64_t rng_mix(uint64_t seed, uint64_t n);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+#include <wchar.h>
+#include <str8.h>
+
+/*
+ *  Contagem das respostas repetidas de uma rodada. Cada resposta é
+ *  normalizada uma única vez (maiúscula e sem acento, ver <fold_char()>),
+ *  direto do UTF-8 e de volta a ele, e contada numa tabela hash de
+ *  endereçamento aberto, de modo que a pontuação da rodada é linear no
+ *  número de jogadores.
+ *
+ *  Os buffers são alocados em <init_tally()> e reaproveitados a cada rodada.
+ */
+
+typedef struct {
+    unsigned hash;
+    int key;   /* início da chave em <keys>, -1 se vazio */
+    int size;  /* bytes da chave */
+    int length; /* caracteres da resposta */
+    int count; /* jogadores com essa mesma resposta */
+} tally_slot;
+
+typedef struct {
+    tally_slot *slot;
+    unsigned capacity; /* potência de 2, ao menos o dobro de jogadores */
+
+    char *keys; /* chaves normalizadas, em UTF-8, uma após a outra */
+    int keys_size;
+    int keys_capacity;
+
+    int *player_slot; /* posição em <slot> da resposta de cada jogador */
+} answer_tally;
+
+int init_tally(answer_tally *tally, int players, int answer_size);
+void free_tally(answer_tally *tally);
+
+void tally_reset(answer_tally *tally);
+int tally_add(answer_tally *tally, int player, const str8 *answer);
+int tally_count(answer_tally *tally, int player);
+int tally_length(answer_tally *tally, int player);
+
+#endif
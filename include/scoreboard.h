@@ -0,0 +1,45 @@
+#ifndef SCOREBOARD_H
+#define SCOREBOARD_H
+
+#include <stdio.h>
+#include <wchar.h>
+
+/*
+ *  Tabela de escores pré-formatada. Larguras de coluna, cabeçalho e nomes
+ *  são formatados uma única vez por jogo em <scoreboard_init()>; depois
+ *  disso, cada <scoreboard_set()> reformata só a célula e o total do
+ *  jogador alterado, e <scoreboard_render()> apenas copia as linhas já
+ *  prontas (todas ou só algumas, nas salas grandes) para um buffer
+ *  preexistente, enviado com uma só escrita.
+ *
+ *  Cada linha guarda todas as colunas de rodada; exibir a rodada <r> é
+ *  usar o prefixo até a coluna <r> seguido da última coluna. Os escores
+ *  em si ficam com o jogo (<game_data>): a tabela só guarda o texto.
+ */
+
+#define SCOREBOARD_HEADER_LINES 4
+#define SCOREBOARD_TOP 10 /* linhas exibidas nas salas maiores que isso */
+
+typedef struct {
+    int players;
+    int rounds;
+    int first_w; /* coluna dos nomes */
+    int cell_w;  /* colunas de rodada e de total: categorias, "Parcial" e o maior total cabem */
+    int line_w;  /* prefixo com todas as rodadas, sem a última coluna */
+
+    wchar_t *header;      /* SCOREBOARD_HEADER_LINES prefixos de <line_w> */
+    wchar_t *header_last; /* última coluna de cada linha do cabeçalho */
+    wchar_t *rows;        /* prefixo de cada jogador */
+    wchar_t *totals;      /* última coluna (total) de cada jogador */
+
+    wchar_t *table; /* saída montada por <scoreboard_render()> */
+} scoreboard;
+
+int scoreboard_init(scoreboard *board, int players, int rounds, int name_size, int max_total,
+                    const wchar_t *names, const wchar_t *const *columns);
+void scoreboard_set(scoreboard *board, int player, int round, int score, int total);
+void scoreboard_render(FILE *stream, scoreboard *board, const int *order, int rows, int round);
+void scoreboard_render_row(FILE *stream, scoreboard *board, int player, int round);
+void scoreboard_free(scoreboard *board);
+
+#endif
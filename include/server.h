@@ -0,0 +1,52 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/*
+ *  Modo servidor: atende, num único processo e numa única thread, várias
+ *  salas simultâneas via <epoll>. Cada conexão TCP é um jogador; as salas
+ *  são preenchidas por ordem de chegada com <players_per_room> jogadores,
+ *  dos quais os <bots> últimos são robôs, que respondem pelo timer da sala, e
+ *  compartilham o diário <log> e o ranking <ranking> (podem ser NULL),
+ *  gravados em lotes, a cada segundo.
+ *
+ *  Cada sala joga com o pacote (<config>, com seu dicionário) vigente
+ *  quando se formou. Ao receber SIGHUP, o servidor relê <config_path> e
+ *  <dict_path> (ver <config_load()>) sem parar: as salas novas usam o
+ *  pacote novo, e o antigo é liberado quando a última sala que o usa
+ *  termina. <config> passa a pertencer ao servidor.
+ *
+ *  A semente de cada sala deriva de <seed> e da ordem em que a sala se
+ *  formou, e é registrada no diário com as rodadas.
+ *
+ *  Com <simultaneous>, cada rodada é jogada de uma vez: todos recebem a
+ *  letra e a categoria juntos e respondem até um único prazo, em vez de
+ *  esperarem a vez; a rodada dura esse prazo, não a soma dos turnos.
+ *
+ *  Com <stats_path>, o resumo das medidas por fase (ver <probe.h>) é
+ *  regravado nesse arquivo a cada segundo e ao receber SIGUSR1, para ser
+ *  lido sem parar o jogo.
+ *
+ *  Retorna 0 ao encerrar normalmente e -1 em caso de erro (ver <errno>).
+ */
+
+#include <config.h>
+#include <stdint.h>
+#include <bot.h>
+#include <journal.h>
+#include <leaderboard.h>
+
+typedef struct {
+    int port;
+    int players_per_room;
+    int bots;            /* últimos assentos de cada sala, ocupados por robôs */
+    bot_profile bot;
+    uint64_t seed;       /* das salas, ver <rng_mix()> */
+    const char *config_path;
+    const char *dict_path;
+    const char *stats_path; /* resumo das medidas; NULL se desligadas */
+    int simultaneous;       /* rodadas com respostas simultâneas */
+} server_options;
+
+int server_run(const server_options *options, game_config *config, journal *log, leaderboard *ranking);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <config.h>
+#include <bot.h>
+#include <journal.h>
+#include <leaderboard.h>
+
+/*
+ *  Modo de simulação: joga <games> partidas completas sem terminal nem
+ *  rede, com jogadores simulados e tempo simulado (nada espera de fato),
+ *  exercitando o mesmo motor do jogo: sorteios, validação das respostas,
+ *  pontuação e tabela de escores. Com a mesma semente, o mesmo dicionário
+ *  e o mesmo roteiro, as partidas se repetem exatamente, servindo de carga
+ *  fixa para medir alterações de desempenho.
+ *
+ *  Com dicionário, os jogadores simulados são robôs (<bot_turn()>, com o
+ *  perfil <bot>) e só os assentos fora dos <bots> últimos seguem o
+ *  roteiro, se houver; sem dicionário, todos respondem pelo roteiro ou
+ *  com palavras inventadas, que quase nunca pontuam.
+ *
+ *  Ao final, imprime partidas/s, turnos/s e o tempo gasto em cada fase.
+ */
+
+#define SIM_SLOTS 10 /* posições (ou faixas delas) no equilíbrio do torneio */
+
+typedef struct {
+    int games;
+    int players;
+    uint64_t seed;      /* a partida <g> joga com <rng_mix(seed, g)> */
+    const char *script; /* respostas, uma por linha; NULL para aleatórias */
+    int bots;           /* últimos assentos, sempre robôs; exigem dicionário */
+    bot_profile bot;
+    int threads;        /* só no torneio */
+} sim_options;
+
+int sim_run(const sim_options *options, game_config *config, journal *log, leaderboard *ranking);
+
+/*
+ *  Modo torneio: as mesmas partidas, independentes entre si, distribuídas
+ *  entre todos os núcleos para medir o equilíbrio de um pacote (pontos e
+ *  tempo esgotado por posição na ordem da rodada, pontos por categoria),
+ *  o que só faz sentido com robôs do dicionário: sem ele, as palavras
+ *  inventadas quase nunca pontuam, e o relatório avisa. O resultado,
+ *  inclusive a verificação, é o mesmo com qualquer número de threads.
+ */
+
+int sim_tournament(const sim_options *options, game_config *config);
+
+#endif
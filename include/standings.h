@@ -0,0 +1,28 @@
+#ifndef STANDINGS_H
+#define STANDINGS_H
+
+#include <treap.h>
+
+/*
+ *  Classificação de uma partida: os jogadores ordenados por total (maior
+ *  primeiro) e, no empate, por assento, numa treap de estatística de
+ *  ordem (<treap.h>), como o ranking geral. Só quem mudou de total na
+ *  rodada é reposicionado, em O(log n); a posição de um jogador sai em
+ *  O(log n) e os K primeiros em O(log n + K), sem reordenar a sala. O
+ *  tempo gasto, que muda para todos a cada rodada, só desempata o
+ *  vencedor (ver <victor()>).
+ */
+
+typedef struct {
+    int *total; /* cópias de <game_data>, para a ordem */
+    treap order;
+    int players;
+} standings;
+
+int standings_init(standings *s, int players);
+void standings_update(standings *s, int player, int total);
+int standings_position(const standings *s, int player);
+int standings_top(const standings *s, int k, int *out);
+void standings_free(standings *s);
+
+#endif
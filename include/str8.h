@@ -0,0 +1,64 @@
+#ifndef STR8_H
+#define STR8_H
+
+#include <wchar.h>
+#include <arena.h>
+
+/*
+ *  Strings UTF-8 com tamanho prefixado, para as respostas: ocupam um byte
+ *  por letra latina sem acento (contra quatro de <wchar_t>), e tamanho e
+ *  número de caracteres ficam guardados, sem varreduras pelo terminador.
+ *  O conteúdo é sempre UTF-8 válido, conferido na criação, de modo que a
+ *  decodificação (<utf8_next()>) dispensa verificações; só é decodificado
+ *  o necessário para comparar letras ou exibir a string.
+ *
+ *  As strings são alocadas em <a> (ver <mem_alloc()>), ou com <malloc()>
+ *  quando <a> é NULL.
+ */
+
+typedef struct {
+    int size;     /* bytes, sem o '\0' final */
+    int length;   /* caracteres */
+    char bytes[]; /* terminados em '\0' */
+} str8;
+
+static inline wchar_t utf8_next(const char **p)
+{ /* decodifica o caractere em <*p>, já validado, e avança */
+    const unsigned char *s = (const unsigned char *)*p;
+    wchar_t c = s[0];
+
+    if (c < 0x80)
+        *p += 1;
+    else if (c < 0xE0)
+        c = ((c & 0x1F) << 6) | (s[1] & 0x3F), *p += 2;
+    else if (c < 0xF0)
+        c = ((c & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F), *p += 3;
+    else
+        c = ((c & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F), *p += 4;
+
+    return c;
+}
+
+static inline int utf8_put(char *dst, wchar_t c)
+{ /* codifica <c> em <dst>; devolve quantos bytes escreveu */
+    unsigned char *d = (unsigned char *)dst;
+
+    if (c < 0x80)
+        return d[0] = c, 1;
+
+    if (c < 0x800)
+        return d[0] = 0xC0 | (c >> 6), d[1] = 0x80 | (c & 0x3F), 2;
+
+    if (c < 0x10000)
+        return d[0] = 0xE0 | (c >> 12), d[1] = 0x80 | ((c >> 6) & 0x3F), d[2] = 0x80 | (c & 0x3F), 3;
+
+    return d[0] = 0xF0 | (c >> 18), d[1] = 0x80 | ((c >> 12) & 0x3F), d[2] = 0x80 | ((c >> 6) & 0x3F), d[3] = 0x80 | (c & 0x3F), 4;
+}
+
+str8 *str8_new(arena *a, const char *bytes, int n);
+str8 *str8_from_wide(arena *a, const wchar_t *s);
+void str8_decode(const str8 *s, wchar_t *dst);
+int str8_starts_with(const str8 *s, wchar_t folded);
+void str8_first_word(str8 *s);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+/*
+ *  Tempo monotônico em nanossegundos (CLOCK_MONOTONIC), imune a ajustes do
+ *  relógio do sistema. Prazos são instantes absolutos nessa escala: o tempo
+ *  restante é sempre recalculado a partir do prazo, sem acumular erros de
+ *  arredondamento a cada espera.
+ */
+
+typedef int64_t nsec;
+
+#define NSEC_PER_SEC 1000000000LL
+
+nsec timer_now(void);
+nsec seconds_to_ns(double sec);
+double ns_to_seconds(nsec ns);
+
+/*
+ *  Fila de prazos sobre um único <timerfd>: um heap mínimo de entradas,
+ *  com o timer armado sempre para a mais próxima, de modo que um laço de
+ *  eventos acompanha qualquer número de prazos com um só descritor.
+ *  As entradas pertencem a quem as usa (embutidas numa sala, por exemplo);
+ *  a fila guarda só ponteiros.
+ */
+
+typedef struct {
+    nsec deadline;
+    int slot; /* posição no heap; -1 se desarmada */
+} timer_entry;
+
+typedef struct {
+    int fd;
+    timer_entry **heap;
+    int count;
+    int capacity;
+    nsec armed; /* prazo para o qual <fd> está armado; 0 se desarmado */
+} timer_queue;
+
+int timer_queue_init(timer_queue *q);
+void timer_queue_free(timer_queue *q);
+void timer_entry_init(timer_entry *e);
+int timer_set(timer_queue *q, timer_entry *e, nsec deadline);
+void timer_cancel(timer_queue *q, timer_entry *e);
+timer_entry *timer_expired(timer_queue *q, nsec now);
+void timer_acknowledge(timer_queue *q);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TREAP_H
+#define TREAP_H
+
+/*
+ *  Treap de estatística de ordem sobre índices 0..n-1: cada nó guarda só
+ *  os filhos e o tamanho da subárvore, e a ordem vem de <ahead>, que
+ *  compara as chaves mantidas por quem usa (em <keys>). Uma chave só pode
+ *  mudar com o índice fora da árvore: <treap_erase()>, altera,
+ *  <treap_insert()>. Inserir, remover e achar a posição de um índice
+ *  custam O(log n); listar os K primeiros, O(log n + K).
+ *
+ *  Usada pelo ranking geral (<leaderboard.h>) e pela classificação de
+ *  cada partida (<standings.h>).
+ */
+
+typedef struct {
+    int left;
+    int right;
+    int size; /* nós na subárvore */
+} treap_node;
+
+typedef int (*treap_order)(const void *keys, int a, int b); /* <a> vem antes de <b>; sem empates */
+
+typedef struct {
+    treap_node *node; /* um por índice, de quem usa; trocado por ele se realocado */
+    int root;         /* -1 se vazia */
+    treap_order ahead;
+    const void *keys;
+} treap;
+
+void treap_init(treap *t, treap_node *node, treap_order ahead, const void *keys);
+void treap_insert(treap *t, int i);
+void treap_erase(treap *t, int i);
+int treap_rank(const treap *t, int i);
+int treap_top(const treap *t, int k, int *out);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef WSTR_H
+#define WSTR_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <arena.h>
+
+/*
+ *  Utilitários de strings largas (<wchar_t>), sem dependência do estado do
+ *  jogo, de modo que ferramentas auxiliares possam ligá-los sem <main.c>.
+ *
+ *  As funções que devolvem strings novas alocam em <a> (ver <mem_alloc()>),
+ *  ou com <malloc()> quando <a> é NULL.
+ *
+ *  <wstr_size()>, <wstr_find()>, <wstr_squeeze()> (copia <n> caracteres
+ *  colapsando espaços repetidos; devolve quantos foram copiados) e
+ *  <wstr_same_folded()> (compara <n> caracteres via <fold_char()>) têm
+ *  versões vetoriais, escolhidas em tempo de execução (ver <wstr_simd.c>).
+ */
+
+static const unsigned long WCHAR_SIZE = sizeof(wchar_t);
+
+#define FOLD_TABLE_SIZE 0x180 /* Latin-1 e Latin Extended-A */
+
+extern const unsigned short fold_table[FOLD_TABLE_SIZE];
+
+static inline wchar_t fold_char(wchar_t c)
+{ /* maiúscula sem acento; a mesma letra para <starts_with()>, <same_str()> e a pontuação */
+    if (c < 128)
+        return (L'a' <= c && c <= L'z')? c - (L'a' - L'A'): c;
+
+    if (c < FOLD_TABLE_SIZE)
+        return fold_table[c];
+
+    c = towupper(c);
+
+    return (c < FOLD_TABLE_SIZE)? fold_table[c]: c;
+}
+
+wchar_t *trim_wstring(arena *a, wchar_t const *s);
+int wstr_size(wchar_t const *s);
+int wstr_find(wchar_t const *s, wchar_t c);
+int wstr_squeeze(wchar_t *dst, wchar_t const *src, int n);
+int wstr_same_folded(wchar_t const *a, wchar_t const *b, int n);
+const char *wstr_isa(void);
+wchar_t *vfwstring(arena *a, const wchar_t *format, va_list ap);
+wchar_t *fwstring(arena *a, const wchar_t *format, ...);
+int starts_with(wchar_t *s, wchar_t l);
+int same_str(wchar_t *a, wchar_t *b);
+int fconcat(FILE *stream, wchar_t *start, wchar_t *end);
+wchar_t *concat(wchar_t *start, wchar_t *end);
+void fcentered(FILE *stream, wchar_t *s, wchar_t placeholder, int field_width);
+wchar_t *centered(wchar_t *s, wchar_t placeholder, int field_width);
+void frepeat(FILE *stream, wchar_t *r, wchar_t *sep, int n);
+int max_str(wchar_t const * const*S, int n);
+
+#endif
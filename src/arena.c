@@ -0,0 +1,140 @@
+#include <stdlib.h>
+#include <string.h>
+#include <arena.h>
+
+#define ARENA_ALIGN 16
+#define align_up(n) (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+void arena_init(arena *a, size_t block_size)
+{
+    a->first = a->current = NULL;
+    a->block_size = block_size;
+    a->last = NULL;
+}
+
+static arena_block *new_block(size_t capacity)
+{
+    arena_block *block = malloc(sizeof(arena_block) + capacity);
+
+    if (block != NULL)
+    {
+        block->next = NULL;
+        block->capacity = capacity;
+        block->used = 0;
+    }
+
+    return block;
+}
+
+void *arena_alloc(arena *a, size_t size)
+{
+    arena_block *block = a->current, *next;
+    size_t start = (block == NULL)? 0: align_up(block->used);
+
+    if (block == NULL || start + size > block->capacity)
+    {
+        /* blocos seguintes já estão vazios desde o último <arena_reset()> */
+        next = (block == NULL)? a->first: block->next;
+
+        if (next == NULL || next->capacity < size)
+        {
+            next = new_block(size > a->block_size? size: a->block_size);
+
+            if (next == NULL)
+                return NULL;
+
+            if (block == NULL)
+            {
+                next->next = a->first;
+                a->first = next;
+            }
+            else
+            {
+                next->next = block->next;
+                block->next = next;
+            }
+        }
+
+        a->current = block = next;
+        start = 0;
+    }
+
+    block->used = start + size;
+
+    return a->last = block->data + start;
+}
+
+void *arena_grow(arena *a, void *p, size_t old_size, size_t new_size)
+{
+    arena_block *block = a->current;
+    unsigned char *q;
+
+    if (p == NULL)
+        return arena_alloc(a, new_size);
+
+    if (p == a->last && (unsigned char *)p - block->data + new_size <= block->capacity)
+    { /* última alocação: basta mover o fim do bloco */
+        block->used = (unsigned char *)p - block->data + new_size;
+        return p;
+    }
+
+    if (new_size <= old_size)
+        return p;
+
+    q = arena_alloc(a, new_size);
+
+    if (q != NULL)
+        memcpy(q, p, old_size);
+
+    return q;
+}
+
+void arena_pop(arena *a, void *p)
+{
+    if (p != NULL && p == a->last)
+    {
+        a->current->used = (unsigned char *)p - a->current->data;
+        a->last = NULL;
+    }
+}
+
+void arena_reset(arena *a)
+{
+    for (arena_block *block = a->first; block != NULL; block = block->next)
+        block->used = 0;
+
+    a->current = a->first;
+    a->last = NULL;
+}
+
+void arena_free(arena *a)
+{
+    arena_block *block;
+
+    while ((block = a->first) != NULL)
+    {
+        a->first = block->next;
+        free(block);
+    }
+
+    a->current = NULL;
+    a->last = NULL;
+}
+
+void *mem_alloc(arena *a, size_t size)
+{
+    return (a == NULL)? malloc(size): arena_alloc(a, size);
+}
+
+void *mem_grow(arena *a, void *p, size_t old_size, size_t new_size)
+{
+    return (a == NULL)? realloc(p, new_size): arena_grow(a, p, old_size, new_size);
+}
+
+void mem_free(arena *a, void *p)
+{
+    if (a == NULL)
+        free(p);
+    else
+        arena_pop(a, p);
+}
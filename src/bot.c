@@ -0,0 +1,172 @@
+#include <stdlib.h>
+#include <string.h>
+#include <main.h>
+#include <bot.h>
+
+typedef struct {
+    bot_index *index;
+    int words_capacity;
+    int text_capacity;
+} builder;
+
+static int add_word(const wchar_t *word, int length, void *context)
+{
+    builder *b = context;
+    bot_index *index = b->index;
+    wchar_t *text;
+    int *grown;
+
+    if (index->words == b->words_capacity)
+    {
+        b->words_capacity = b->words_capacity? 2 * b->words_capacity: 256;
+
+        if ((grown = realloc(index->word, b->words_capacity * sizeof(int))) == NULL)
+            return -1;
+
+        index->word = grown;
+    }
+
+    if (index->text_size + length + 1 > b->text_capacity)
+    {
+        b->text_capacity = 2 * (index->text_size + length + 1);
+
+        if ((text = realloc(index->text, b->text_capacity * sizeof(wchar_t))) == NULL)
+            return -1;
+
+        index->text = text;
+    }
+
+    index->word[index->words++] = index->text_size;
+    wmemcpy(index->text + index->text_size, word, length);
+    index->text[index->text_size + length] = 0;
+    index->text_size += length + 1;
+
+    return 0;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Indexa as palavras de até <max_length> caracteres das <categories>
+ *  categorias de <dict> por categoria e letra inicial. O percurso do
+ *  dicionário já é alfabético, então as palavras de cada letra ficam
+ *  contíguas.
+ *
+ *  - RETORNO:
+ *
+ *  o índice, ou NULL se faltar memória.
+ */
+
+bot_index *bot_index_build(const dictionary *dict, int categories, int max_length)
+{
+    bot_index *index = calloc(1, sizeof(bot_index));
+    builder b = {index, 0, 0};
+    bot_list *list;
+    int start, letter;
+
+    if (index == NULL || (index->list = calloc(categories * BOT_LETTERS, sizeof(bot_list))) == NULL)
+    {
+        bot_index_free(index);
+        return NULL;
+    }
+
+    index->categories = categories;
+
+    for (int c = 0; c < categories; c++)
+    {
+        start = index->words;
+
+        if (dict_walk(dict, c, max_length, add_word, &b) == -1)
+        {
+            bot_index_free(index);
+            return NULL;
+        }
+
+        for (int w = start; w < index->words; w++)
+        {
+            letter = index->text[index->word[w]] - L'A';
+
+            if (letter < 0 || letter >= BOT_LETTERS)
+                continue;
+
+            list = &index->list[c * BOT_LETTERS + letter];
+
+            if (list->count++ == 0)
+                list->first = w;
+        }
+    }
+
+    return index;
+}
+
+void bot_index_free(bot_index *index)
+{
+    if (index == NULL)
+        return;
+
+    free(index->list);
+    free(index->word);
+    free(index->text);
+    free(index);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Decide a jogada de <bot> na categoria <category> com a letra <letter>,
+ *  tendo <budget> segundos, com os sorteios de <g>. Quanto maior a habilidade, maior a chance de
+ *  saber alguma palavra e mais palavras são sorteadas para ficar com a
+ *  mais longa (vale mais pontos e coincide menos com as dos outros).
+ *
+ *  - RETORNO:
+ *
+ *  a resposta, alocada em <a>, com o tempo que o robô leva para dá-la em
+ *  <*latency>; ou NULL se o robô não souber responder, com <*latency>
+ *  igual a <budget> (deixa o tempo se esgotar).
+ */
+
+wchar_t *bot_answer(arena *a, rng *g, const bot_index *index, const bot_profile *bot, int category, wchar_t letter, double budget, double *latency)
+{
+    const bot_list *list;
+    const wchar_t *word, *best = NULL;
+    int tries = 1 + (int)(4 * bot->skill), length, best_length = 0, i;
+    wchar_t *answer;
+
+    letter = fold_char(letter) - L'A';
+    *latency = bot->latency * (.5 + rng_unit(g));
+
+    if (index == NULL || category >= index->categories || letter < 0 || letter >= BOT_LETTERS)
+        list = NULL;
+    else
+        list = &index->list[category * BOT_LETTERS + letter];
+
+    if (list == NULL || list->count == 0 || rng_unit(g) >= .35 + .65 * bot->skill || *latency >= budget)
+    {
+        *latency = budget;
+        return NULL;
+    }
+
+    while (tries-- > 0)
+    {
+        word = index->text + index->word[list->first + rng_range(g, 0, list->count)];
+
+        if ((length = wcslen(word)) > best_length)
+        {
+            best = word;
+            best_length = length;
+        }
+    }
+
+    if ((answer = mem_alloc(a, (best_length + 1) * WCHAR_SIZE)) == NULL)
+    { /* sem memória, o robô também deixa o tempo se esgotar */
+        *latency = budget;
+        return NULL;
+    }
+
+    for (i = 0; i < best_length; i++) /* maiúscula só no início de cada palavra */
+        answer[i] = (i == 0 || best[i - 1] == L' ')? best[i]: towlower(best[i]);
+
+    answer[i] = 0;
+
+    return answer;
+}
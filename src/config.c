@@ -0,0 +1,314 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <wctype.h>
+#include <config.h>
+#include <reader.h>
+#include <leaderboard.h>
+#include <wstr.h>
+
+static const wchar_t builtin[] =
+    L"letras: ABCDEFGHIJLMNOPQRSTUVXZ\n"
+    L"rodadas: 5\n"
+    L"tempo: 8 2\n"
+    L"nome: 12\n"
+    L"resposta: 30\n"
+    L"categoria-nome: Pessoas\n"
+    L"categoria: Cidades\n"
+    L"categoria: Animais\n"
+    L"categoria: Comidas\n"
+    L"categoria: Profissões\n";
+
+typedef struct {
+    game_config *config;
+    int categories_seen; /* as do arquivo substituem as embutidas */
+} loader;
+
+static wchar_t *strip(wchar_t *s)
+{ /* sem espaços nas pontas nem comentário */
+    wchar_t *end;
+
+    if ((end = wcschr(s, L'#')) != NULL)
+        *end = 0;
+
+    while (iswspace(*s))
+        s++;
+
+    for (end = s + wcslen(s); end > s && iswspace(end[-1]); end--)
+        ;
+
+    *end = 0;
+
+    return s;
+}
+
+static const wchar_t *copy(game_config *config, const wchar_t *s, int n)
+{
+    wchar_t *t = arena_alloc(&config->tables, (n + 1) * sizeof(wchar_t));
+
+    if (t != NULL)
+    {
+        wmemcpy(t, s, n);
+        t[n] = 0;
+    }
+
+    return t;
+}
+
+static int set_letters(game_config *config, const wchar_t *value)
+{ /* letras distintas, cada uma de A a Z depois de normalizada */
+    int n = wcslen(value), seen = 0;
+    wchar_t *folded;
+
+    if (n == 0 || n > 26 || (folded = arena_alloc(&config->tables, (n + 1) * sizeof(wchar_t))) == NULL)
+        return -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        folded[i] = fold_char(value[i]);
+
+        if (folded[i] < L'A' || folded[i] > L'Z' || seen & (1 << (folded[i] - L'A')))
+            return -1;
+
+        seen |= 1 << (folded[i] - L'A');
+    }
+
+    folded[n] = 0;
+
+    config->number_of_letters = n;
+    config->folded_letters = folded;
+
+    return (config->letters = copy(config, value, n)) == NULL? -1: 0;
+}
+
+static int add_category(loader *l, const wchar_t *name, int first_word)
+{
+    game_config *config = l->config;
+    int n = wcslen(name), c;
+
+    if (!l->categories_seen)
+    {
+        config->number_of_categories = 0;
+        l->categories_seen = 1;
+    }
+
+    if (n == 0 || config->number_of_categories == CONFIG_CATEGORIES)
+        return -1;
+
+    for (c = 0; c < config->number_of_categories; c++)
+        if (wcscmp(config->categories[c], name) == 0)
+            return -1;
+
+    if ((config->categories[c] = copy(config, name, n)) == NULL)
+        return -1;
+
+    config->first_word[c] = first_word;
+    config->number_of_categories++;
+
+    return 0;
+}
+
+static int parse_int(const wchar_t *value, int min, int max, int *out)
+{
+    wchar_t *end;
+    long n = wcstol(value, &end, 10);
+
+    if (end == value || *end != 0 || n < min || n > max)
+        return -1;
+
+    *out = n;
+
+    return 0;
+}
+
+static int parse_line(loader *l, wchar_t *line)
+{ /* 0 se a linha for válida (ou vazia), -1 caso contrário */
+    game_config *config = l->config;
+    wchar_t *key = strip(line), *value, *end;
+
+    if (*key == 0)
+        return 0;
+
+    if ((value = wcschr(key, L':')) == NULL)
+        return -1;
+
+    *value++ = 0;
+    key = strip(key);
+    value = strip(value);
+
+    if (wcscmp(key, L"letras") == 0)
+        return set_letters(config, value);
+
+    if (wcscmp(key, L"rodadas") == 0)
+        return parse_int(value, 1, 99, &config->rounds);
+
+    if (wcscmp(key, L"nome") == 0) /* cada caractere ocupa até 4 bytes no ranking */
+        return parse_int(value, 1, (LEADERBOARD_NAME - 1) / 4, &config->name_size);
+
+    if (wcscmp(key, L"resposta") == 0) /* o leitor guarda no máximo READER_LINE bytes */
+        return parse_int(value, 1, READER_LINE / 4 - 1, &config->answer_size);
+
+    if (wcscmp(key, L"categoria") == 0)
+        return add_category(l, value, 0);
+
+    if (wcscmp(key, L"categoria-nome") == 0)
+        return add_category(l, value, 1);
+
+    if (wcscmp(key, L"tempo") == 0)
+    {
+        config->min_time = wcstod(value, &end);
+
+        if (end == value || config->min_time <= 0)
+            return -1;
+
+        value = end;
+        config->time_decrement = wcstod(value, &end);
+
+        return (end == value || *strip(end) != 0 || config->time_decrement < 0)? -1: 0;
+    }
+
+    return -1;
+}
+
+static int parse_text(loader *l, const wchar_t *text)
+{ /* pacote embutido */
+    wchar_t line[CONFIG_LINE];
+    const wchar_t *end;
+
+    for (; *text != 0; text = end + (*end != 0))
+    {
+        end = wcschr(text, L'\n');
+        end = (end != NULL)? end: text + wcslen(text);
+
+        wmemcpy(line, text, end - text);
+        line[end - text] = 0;
+
+        if (parse_line(l, line) == -1)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int parse_file(loader *l, const char *path, int *error_line)
+{ /* linha do erro em <*error_line>, 0 se o arquivo não pôde ser lido */
+    wchar_t line[CONFIG_LINE];
+    FILE *f = fopen(path, "r");
+    int n = 0;
+
+    if (f == NULL)
+        return -1;
+
+    while (fgetws(line, CONFIG_LINE, f) != NULL)
+    {
+        n++;
+
+        if ((wcschr(line, L'\n') == NULL && !feof(f)) || parse_line(l, line) == -1)
+        { /* linha longa demais ou inválida */
+            *error_line = n;
+            fclose(f);
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    if (ferror(f))
+    {
+        fclose(f);
+        return -1;
+    }
+
+    fclose(f);
+
+    return 0;
+}
+
+static void derive_tables(game_config *config)
+{
+    config->category_width = 0;
+
+    for (int c = 0; c < config->number_of_categories; c++)
+        if ((int)wcslen(config->categories[c]) > config->category_width)
+            config->category_width = wcslen(config->categories[c]);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Carrega o pacote em <path> (NULL para o embutido) sobre os valores do
+ *  embutido e abre o dicionário em <dict_path> (pode ser NULL) para as
+ *  categorias do pacote. O pacote devolvido tem uma referência, a ser
+ *  solta com <config_release()>.
+ *
+ *  - RETORNO:
+ *
+ *  o pacote, ou NULL em caso de erro (ver <errno>). Nesse caso,
+ *  <*error_line> (se não NULL) recebe o número da linha inválida de
+ *  <path> (com <errno> EINVAL), 0 se <path> (ou o embutido, quando
+ *  <path> é NULL) não pôde ser carregado ou -1 se foi o dicionário, ou o
+ *  índice dos robôs montado a partir dele, que falhou.
+ */
+
+game_config *config_load(const char *path, const char *dict_path, int *error_line)
+{
+    game_config *config = calloc(1, sizeof(game_config));
+    loader l = {config, 0};
+    int line = 0;
+
+    if (config == NULL)
+        return NULL;
+
+    arena_init(&config->tables, 4096);
+    config->refs = 1;
+
+    if (parse_text(&l, builtin) == -1)
+        goto fail;
+
+    l.categories_seen = 0;
+
+    if (path != NULL && parse_file(&l, path, &line) == -1)
+        goto fail;
+
+    derive_tables(config);
+
+    if (dict_path != NULL && (config->dictionary = dict_open(dict_path, config->categories, config->number_of_categories)) == NULL)
+    {
+        line = -1;
+        goto fail;
+    }
+
+    if (config->dictionary != NULL && (config->bots = bot_index_build(config->dictionary, config->number_of_categories, config->answer_size)) == NULL)
+    { /* o índice dos robôs sai do dicionário */
+        line = -1;
+        goto fail;
+    }
+
+    return config;
+
+fail:
+    if (error_line != NULL)
+        *error_line = line;
+
+    config_release(config);
+
+    return NULL;
+}
+
+game_config *config_retain(game_config *config)
+{
+    __atomic_add_fetch(&config->refs, 1, __ATOMIC_RELAXED);
+
+    return config;
+}
+
+void config_release(game_config *config)
+{ /* libera o pacote ao soltar a última referência */
+    if (config == NULL || __atomic_sub_fetch(&config->refs, 1, __ATOMIC_ACQ_REL) > 0)
+        return;
+
+    bot_index_free((bot_index *)config->bots);
+    dict_free((dictionary *)config->dictionary);
+    arena_free(&config->tables);
+    free(config);
+}
@@ -0,0 +1,767 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <wctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <wstr.h>
+#include <dict.h>
+
+#define MAX_WORD 64
+#define MAX_NAME 256
+
+typedef struct {
+    int category;
+    int key; /* em <pool> */
+} raw_entry;
+
+static const wchar_t *sort_pool; /* <qsort()> não repassa contexto */
+
+static int compare_entries(const void *a, const void *b)
+{
+    const raw_entry *x = a, *y = b;
+
+    if (x->category != y->category)
+        return x->category - y->category;
+
+    return wcscmp(sort_pool + x->key, sort_pool + y->key);
+}
+
+static int fold_word(wchar_t *key, const wchar_t *word, int max)
+{ /* normaliza <word> em <key>; devolve o tamanho, ou -1 se não couber */
+    int n;
+
+    for (n = 0; word[n] != 0; n++)
+    {
+        if (n == max)
+            return -1;
+
+        key[n] = fold_char(word[n]);
+    }
+
+    key[n] = 0;
+
+    return n;
+}
+
+static void category_name(char *dst, const wchar_t *category)
+{ /* "Profissões" -> "profissoes", com no máximo MAX_NAME - 1 bytes */
+    size_t n;
+    wchar_t c;
+
+    for (n = 0; category[n] != 0 && n < MAX_NAME - 1; n++)
+    {
+        c = towlower(fold_char(category[n]));
+        dst[n] = (c == L' ')? '_': (c < 128)? (char)c: '_';
+    }
+
+    dst[n] = 0;
+}
+
+static char *list_path(const char *dir, const char *name)
+{ /* "<dir>/<name>.txt" */
+    char *path = malloc(strlen(dir) + strlen(name) + 6);
+
+    if (path != NULL)
+        sprintf(path, "%s/%s.txt", dir, name);
+
+    return path;
+}
+
+static void list_name(char *dst, const char *path)
+{ /* "dic/profissoes.txt" -> "profissoes" */
+    const char *base = strrchr(path, '/');
+    size_t n;
+
+    base = (base == NULL)? path: base + 1;
+    n = strlen(base);
+
+    if (n > 4 && strcmp(base + n - 4, ".txt") == 0)
+        n -= 4;
+
+    if (n > MAX_NAME - 1)
+        n = MAX_NAME - 1;
+
+    memcpy(dst, base, n);
+    dst[n] = 0;
+}
+
+typedef struct {
+    raw_entry *entry;
+    int entries;
+    int entries_cap;
+    wchar_t *pool;
+    int pool_size;
+    int pool_cap;
+} builder;
+
+static int add_word(builder *b, int category, const wchar_t *word)
+{
+    wchar_t key[MAX_WORD + 1];
+    int n = fold_word(key, word, MAX_WORD);
+    void *grown;
+
+    if (n <= 0)
+        return 0; /* vazia ou longa demais para ser resposta */
+
+    if (b->entries == b->entries_cap)
+    {
+        b->entries_cap = b->entries_cap? 2 * b->entries_cap: 1024;
+
+        if ((grown = realloc(b->entry, b->entries_cap * sizeof(raw_entry))) == NULL)
+            return -1;
+
+        b->entry = grown;
+    }
+
+    if (b->pool_size + n + 1 > b->pool_cap)
+    {
+        b->pool_cap = b->pool_cap? 2 * b->pool_cap: 16384;
+
+        while (b->pool_size + n + 1 > b->pool_cap)
+            b->pool_cap *= 2;
+
+        if ((grown = realloc(b->pool, b->pool_cap * sizeof(wchar_t))) == NULL)
+            return -1;
+
+        b->pool = grown;
+    }
+
+    wmemcpy(b->pool + b->pool_size, key, n + 1);
+
+    b->entry[b->entries].category = category;
+    b->entry[b->entries].key = b->pool_size;
+    b->entries++;
+    b->pool_size += n + 1;
+
+    return 0;
+}
+
+static int decode_utf8(wchar_t *dst, int max, const char *src)
+{ /* decodifica independentemente do locale; -1 se inválida ou longa demais */
+    const unsigned char *p = (const unsigned char *)src;
+    unsigned c;
+    int n = 0, extra;
+
+    while (*p != 0 && *p != '\n' && *p != '\r')
+    {
+        c = *p++;
+
+        if (c < 0x80)
+            extra = 0;
+        else if ((c & 0xE0) == 0xC0)
+            extra = 1, c &= 0x1F;
+        else if ((c & 0xF0) == 0xE0)
+            extra = 2, c &= 0x0F;
+        else if ((c & 0xF8) == 0xF0)
+            extra = 3, c &= 0x07;
+        else
+            return -1;
+
+        while (extra-- > 0)
+        {
+            if ((*p & 0xC0) != 0x80)
+                return -1;
+            c = (c << 6) | (*p++ & 0x3F);
+        }
+
+        if (n == max)
+            return -1;
+
+        dst[n++] = c;
+    }
+
+    dst[n] = 0;
+
+    return n;
+}
+
+static int load_list(builder *b, FILE *f, int category)
+{ /* uma palavra por linha; linhas vazias e iniciadas por '#' são ignoradas */
+    char line[4 * MAX_WORD + 2];
+    wchar_t decoded[MAX_WORD + 1], *word;
+    int status = 0, c;
+
+    while (status == 0 && fgets(line, sizeof(line), f) != NULL)
+    {
+        if (strchr(line, '\n') == NULL && !feof(f))
+        { /* longa demais: descarta o resto da linha */
+            while ((c = fgetc(f)) != EOF && c != '\n')
+                ;
+            continue;
+        }
+
+        if (decode_utf8(decoded, MAX_WORD, line) == -1)
+            continue; /* palavra inválida ou longa demais para ser resposta */
+
+        if ((word = trim_wstring(NULL, decoded)) == NULL)
+            return -1;
+
+        if (word[0] != L'#')
+            status = add_word(b, category, word);
+
+        free(word);
+    }
+
+    return status;
+}
+
+/*
+ *  Construção incremental do autômato mínimo (Daciuk et al.): com as
+ *  palavras ordenadas, os nós do caminho da palavra anterior que ficam
+ *  abaixo do prefixo comum com a atual não recebem mais arestas, e são
+ *  então "congelados": trocados por um nó equivalente já emitido, se
+ *  houver no registro, ou emitidos no fim de <edge>.
+ */
+
+typedef struct {
+    dict_edge *edge;
+    int count;
+    int cap;
+} pending_node;
+
+typedef struct {
+    dict_edge *edge; /* arestas emitidas; a 0 é sentinela */
+    uint32_t edges;
+    uint32_t edges_cap;
+    uint32_t *slot;  /* registro de nós emitidos, por endereçamento aberto */
+    uint32_t slots;
+    uint32_t registered;
+    int failed;
+} automaton;
+
+static uint32_t hash_edges(const dict_edge *e, int n)
+{ /* FNV-1a */
+    uint32_t h = 2166136261u;
+
+    for (int i = 0; i < n; i++)
+    {
+        h = (h ^ e[i].label) * 16777619u;
+        h = (h ^ e[i].target) * 16777619u;
+    }
+
+    return h;
+}
+
+static int node_size(const automaton *a, uint32_t id)
+{
+    int n = 1;
+
+    while (!(a->edge[id + n - 1].label & DICT_LAST))
+        n++;
+
+    return n;
+}
+
+static int grow_register(automaton *a)
+{
+    uint32_t slots = a->slots? 2 * a->slots: 4096, *slot = calloc(slots, sizeof(uint32_t)), i, h;
+
+    if (slot == NULL)
+        return -1;
+
+    for (i = 0; i < a->slots; i++)
+    {
+        if (a->slot[i] == 0)
+            continue;
+
+        h = hash_edges(a->edge + a->slot[i], node_size(a, a->slot[i])) & (slots - 1);
+
+        while (slot[h] != 0)
+            h = (h + 1) & (slots - 1);
+
+        slot[h] = a->slot[i];
+    }
+
+    free(a->slot);
+    a->slot = slot;
+    a->slots = slots;
+
+    return 0;
+}
+
+static uint32_t emit(automaton *a, pending_node *node)
+{ /* devolve o nó equivalente a <node>, emitindo-o se for inédito */
+    uint32_t h, id;
+    void *grown;
+
+    if (node->count == 0 || a->failed)
+        return 0;
+
+    node->edge[node->count - 1].label |= DICT_LAST;
+
+    if (2 * (a->registered + 1) > a->slots && grow_register(a) == -1)
+    {
+        a->failed = 1;
+        return 0;
+    }
+
+    h = hash_edges(node->edge, node->count) & (a->slots - 1);
+
+    while ((id = a->slot[h]) != 0)
+    {
+        if (memcmp(a->edge + id, node->edge, node->count * sizeof(dict_edge)) == 0)
+            return id; /* <DICT_LAST> só na última: mesmas arestas, mesmo nó */
+
+        h = (h + 1) & (a->slots - 1);
+    }
+
+    if (a->edges + node->count > a->edges_cap)
+    {
+        a->edges_cap = a->edges_cap? 2 * a->edges_cap: 4096;
+
+        while (a->edges + node->count > a->edges_cap)
+            a->edges_cap *= 2;
+
+        if ((grown = realloc(a->edge, a->edges_cap * sizeof(dict_edge))) == NULL)
+        {
+            a->failed = 1;
+            return 0;
+        }
+
+        a->edge = grown;
+    }
+
+    id = a->edges;
+    memcpy(a->edge + id, node->edge, node->count * sizeof(dict_edge));
+    a->edges += node->count;
+
+    a->slot[h] = id;
+    a->registered++;
+
+    return id;
+}
+
+static int push_edge(pending_node *node, wchar_t label, uint32_t flags)
+{
+    void *grown;
+
+    if (node->count == node->cap)
+    {
+        node->cap = node->cap? 2 * node->cap: 8;
+
+        if ((grown = realloc(node->edge, node->cap * sizeof(dict_edge))) == NULL)
+            return -1;
+
+        node->edge = grown;
+    }
+
+    node->edge[node->count].label = ((uint32_t)label & DICT_LABEL) | flags;
+    node->edge[node->count].target = 0;
+    node->count++;
+
+    return 0;
+}
+
+static void freeze(automaton *a, pending_node *stack, int from, int to)
+{ /* congela os nós de profundidade <from> até <to> + 1 */
+    pending_node *parent;
+
+    for (int k = from; k > to; k--)
+    {
+        parent = &stack[k - 1];
+        parent->edge[parent->count - 1].target = emit(a, &stack[k]);
+        stack[k].count = 0;
+    }
+}
+
+static uint32_t build_category(automaton *a, pending_node *stack, const wchar_t *pool, const raw_entry *entry, int n)
+{
+    const wchar_t *prev = L"", *word;
+    int depth = 0, common, len, k;
+
+    stack[0].count = 0;
+
+    for (int i = 0; i < n && !a->failed; i++)
+    {
+        word = pool + entry[i].key;
+        len = wcslen(word);
+
+        for (common = 0; common < depth && word[common] == prev[common]; common++)
+            ;
+
+        if (common == len && len == depth)
+            continue; /* repetida */
+
+        freeze(a, stack, depth, common);
+
+        for (k = common; k < len; k++)
+        {
+            if (push_edge(&stack[k], word[k], (k == len - 1)? DICT_FINAL: 0) == -1)
+                a->failed = 1;
+
+            stack[k + 1].count = 0;
+        }
+
+        depth = len;
+        prev = word;
+    }
+
+    freeze(a, stack, depth, 0);
+
+    return emit(a, &stack[0]);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Compila as <n> listas em <paths> (UTF-8, uma palavra por linha de até
+ *  <MAX_WORD> caracteres) numa imagem de dicionário; cada lista vira uma
+ *  categoria, nomeada pelo arquivo sem o ".txt".
+ *
+ *  - RETORNO:
+ *
+ *  a imagem, alocada com <malloc()>, e seu tamanho em <*size>; ou NULL em
+ *  caso de erro (ver <errno>).
+ */
+
+void *dict_compile(char *const *paths, int n, size_t *size)
+{
+    builder b = {NULL, 0, 0, NULL, 0, 0};
+    automaton a = {NULL, 0, 0, NULL, 0, 0, 0};
+    pending_node stack[MAX_WORD + 1];
+    dict_edge sentinel = {DICT_LAST, 0};
+    uint32_t *roots = calloc(n + 1, sizeof(uint32_t));
+    char name[MAX_NAME];
+    dict_header *header;
+    dict_category *category;
+    unsigned char *image = NULL;
+    char *names;
+    size_t names_size = 0, offset;
+    FILE *f;
+    int i, first, status = (roots == NULL)? -1: 0;
+
+    memset(stack, 0, sizeof(stack));
+
+    for (i = 0; status == 0 && i < n; i++)
+    {
+        if ((f = fopen(paths[i], "r")) == NULL)
+        {
+            status = -1;
+            break;
+        }
+
+        status = load_list(&b, f, i);
+        fclose(f);
+
+        list_name(name, paths[i]);
+        names_size += strlen(name) + 1;
+    }
+
+    if (status == 0)
+    {
+        sort_pool = b.pool;
+        qsort(b.entry, b.entries, sizeof(raw_entry), compare_entries);
+
+        a.edges_cap = 4096;
+
+        if ((a.edge = malloc(a.edges_cap * sizeof(dict_edge))) == NULL)
+            status = -1;
+        else
+            a.edge[a.edges++] = sentinel; /* reserva o índice 0 */
+    }
+
+    for (i = 0, first = 0; status == 0 && i < n; i++)
+    {
+        int count = 0;
+
+        while (first + count < b.entries && b.entry[first + count].category == i)
+            count++;
+
+        roots[i] = build_category(&a, stack, b.pool, b.entry + first, count);
+        first += count;
+
+        if (a.failed)
+            status = -1;
+    }
+
+    if (status == 0)
+    {
+        *size = sizeof(dict_header) + n * sizeof(dict_category) + a.edges * sizeof(dict_edge) + names_size;
+
+        if ((image = malloc(*size)) == NULL)
+            status = -1;
+    }
+
+    if (status == 0)
+    {
+        header = (dict_header *)image;
+        header->magic = DICT_MAGIC;
+        header->version = DICT_VERSION;
+        header->categories = n;
+        header->edges = a.edges;
+        header->names_size = names_size;
+
+        category = (dict_category *)(header + 1);
+        memcpy(category + n, a.edge, a.edges * sizeof(dict_edge));
+        names = (char *)((dict_edge *)(category + n) + a.edges);
+
+        offset = 0;
+
+        for (i = 0; i < n; i++)
+        {
+            list_name(name, paths[i]);
+
+            category[i].root = roots[i];
+            category[i].name = offset;
+
+            strcpy(names + offset, name);
+            offset += strlen(name) + 1;
+        }
+    }
+
+    for (i = 0; i <= MAX_WORD; i++)
+        free(stack[i].edge);
+
+    free(a.edge);
+    free(a.slot);
+    free(b.entry);
+    free(b.pool);
+    free(roots);
+
+    return image;
+}
+
+static void *list_image(const char *dir, const wchar_t *const *categories, int n, size_t *size)
+{ /* compila as listas de <dir> que existirem para as categorias do jogo */
+    char **paths = calloc(n + 1, sizeof(char *)), name[MAX_NAME];
+    struct stat st;
+    void *image = NULL;
+    int i, found = 0, status = (paths == NULL)? -1: 0;
+
+    for (i = 0; status == 0 && i < n; i++)
+    {
+        category_name(name, categories[i]);
+
+        if ((paths[found] = list_path(dir, name)) == NULL)
+            status = -1;
+        else if (stat(paths[found], &st) == 0)
+            found++;
+        else if (errno == ENOENT)
+            free(paths[found]), paths[found] = NULL;
+        else
+            status = -1;
+    }
+
+    if (status == 0)
+        image = dict_compile(paths, found, size);
+
+    for (i = 0; paths != NULL && paths[i] != NULL; i++)
+        free(paths[i]);
+
+    free(paths);
+
+    return image;
+}
+
+static void *map_image(const char *path, size_t *size)
+{
+    struct stat st;
+    void *image;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1)
+        return NULL;
+
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    if (st.st_size < (off_t)sizeof(dict_header))
+    {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    *size = st.st_size;
+    image = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); /* o mapeamento se mantém */
+
+    return (image == MAP_FAILED)? NULL: image;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Abre o dicionário em <path>: um arquivo gerado por <dictc>, que é
+ *  mapeado na memória, ou um diretório com as listas "<categoria>.txt"
+ *  (nome em minúsculas e sem acentos), compiladas na hora. Cada uma das
+ *  <n> categorias do jogo é associada à lista de mesmo nome.
+ *
+ *  - RETORNO:
+ *
+ *  o dicionário, ou NULL em caso de erro (ver <errno>). Categorias sem
+ *  lista aceitam qualquer palavra.
+ */
+
+dictionary *dict_open(const char *path, const wchar_t *const *categories, int n)
+{
+    dictionary *dict = calloc(1, sizeof(dictionary));
+    const dict_header *header;
+    const dict_category *category;
+    const char *names;
+    char name[MAX_NAME];
+    struct stat st;
+    uint64_t needed;
+    uint32_t j;
+    int i;
+
+    if (dict == NULL)
+        return NULL;
+
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+        dict->image = list_image(path, categories, n, &dict->size);
+    else if ((dict->image = map_image(path, &dict->size)) != NULL)
+        dict->mapped = 1;
+
+    if (dict->image == NULL || (dict->root = malloc(n * sizeof(uint32_t))) == NULL)
+    {
+        dict_free(dict);
+        return NULL;
+    }
+
+    header = dict->image;
+    category = (const dict_category *)(header + 1);
+    dict->edge = (const dict_edge *)(category + header->categories);
+    dict->edges = header->edges;
+    dict->categories = n;
+    names = (const char *)(dict->edge + dict->edges);
+
+    needed = sizeof(dict_header) + (uint64_t)header->categories * sizeof(dict_category) +
+        (uint64_t)header->edges * sizeof(dict_edge) + header->names_size;
+
+    if (header->magic != DICT_MAGIC || header->version != DICT_VERSION || needed > dict->size ||
+        header->edges == 0 || (header->names_size > 0 && names[header->names_size - 1] != 0))
+    {
+        dict_free(dict);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        category_name(name, categories[i]);
+        dict->root[i] = DICT_NO_LIST;
+
+        for (j = 0; j < header->categories; j++)
+        {
+            if (category[j].name < header->names_size && strcmp(names + category[j].name, name) == 0)
+            {
+                dict->root[i] = (category[j].root < dict->edges)? category[j].root: 0;
+                break;
+            }
+        }
+    }
+
+    return dict;
+}
+
+int dict_has_category(const dictionary *dict, int category)
+{
+    return dict != NULL && category < dict->categories && dict->root[category] != DICT_NO_LIST;
+}
+
+int dict_contains(const dictionary *dict, int category, const str8 *word)
+{
+    const dict_edge *e = NULL;
+    const char *p = word->bytes, *end = word->bytes + word->size;
+    uint32_t node, c;
+
+    if (!dict_has_category(dict, category))
+        return 1;
+
+    node = dict->root[category];
+
+    while (p < end)
+    {
+        if (node == 0)
+            return 0;
+
+        c = (uint32_t)fold_char(utf8_next(&p)) & DICT_LABEL;
+
+        for (e = dict->edge + node; (e->label & DICT_LABEL) < c; e++)
+        { /* arestas em ordem crescente de letra */
+            if ((e->label & DICT_LAST) || e + 1 == dict->edge + dict->edges)
+                return 0;
+        }
+
+        if ((e->label & DICT_LABEL) != c)
+            return 0;
+
+        node = (e->target < dict->edges)? e->target: 0;
+    }
+
+    return e != NULL && (e->label & DICT_FINAL);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Percorre as palavras de <category> com até <max_length> caracteres, em
+ *  ordem alfabética (normalizadas, ver <fold_char()>), chamando
+ *  <visit(word, length, context)> para cada uma; <word> só vale durante a
+ *  chamada.
+ *
+ *  - RETORNO:
+ *
+ *  0 ao fim do percurso, ou -1 assim que <visit()> retornar -1.
+ */
+
+int dict_walk(const dictionary *dict, int category, int max_length,
+              int (*visit)(const wchar_t *word, int length, void *context), void *context)
+{
+    const dict_edge *stack[max_length + 1], *e;
+    wchar_t word[max_length + 1];
+    int depth = 0;
+    uint32_t node;
+
+    if (!dict_has_category(dict, category) || (node = dict->root[category]) == 0 || max_length < 1)
+        return 0;
+
+    stack[0] = dict->edge + node;
+
+    while (depth >= 0)
+    {
+        e = stack[depth];
+        word[depth] = e->label & DICT_LABEL;
+
+        if ((e->label & DICT_FINAL) && visit(word, depth + 1, context) == -1)
+            return -1;
+
+        node = (e->target < dict->edges)? e->target: 0;
+
+        if (node != 0 && depth + 1 < max_length)
+        { /* desce: a próxima letra começa pela primeira aresta do destino */
+            stack[++depth] = dict->edge + node;
+            continue;
+        }
+
+        while (depth >= 0 && ((stack[depth]->label & DICT_LAST) || stack[depth] + 1 == dict->edge + dict->edges))
+            depth--; /* nó esgotado: volta à letra anterior */
+
+        if (depth >= 0)
+            stack[depth]++;
+    }
+
+    return 0;
+}
+
+void dict_free(dictionary *dict)
+{
+    if (dict == NULL)
+        return;
+
+    if (dict->mapped)
+        munmap(dict->image, dict->size);
+    else
+        free(dict->image);
+
+    free(dict->root);
+    free(dict);
+}
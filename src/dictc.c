@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <locale.h>
+#include <dict.h>
+
+/*
+ *  Compilador de dicionário: <$ ./dictc <saída> <lista.txt>...>
+ *
+ *  Cada lista (UTF-8, uma palavra por linha) vira uma categoria do arquivo
+ *  <saída>, nomeada pelo arquivo sem o ".txt"; o jogo o abre com
+ *  <--dicionario <saída>>. A saída é escrita num temporário e renomeada ao
+ *  final, de modo que um processo que a mapeie nunca veja um arquivo pela
+ *  metade.
+ */
+
+int main(int argc, char *argv[])
+{
+    const dict_header *header;
+    size_t size;
+    void *image;
+    char *temp;
+    FILE *f;
+    int written = 0, status = EXIT_SUCCESS;
+
+    setlocale(LC_ALL, "");
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "Uso: %s <saída> <lista.txt>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ((image = dict_compile(argv + 2, argc - 2, &size)) == NULL)
+    {
+        fprintf(stderr, "Falha ao compilar as listas: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if ((temp = malloc(strlen(argv[1]) + 5)) == NULL)
+    {
+        free(image);
+        return EXIT_FAILURE;
+    }
+
+    sprintf(temp, "%s.tmp", argv[1]);
+
+    if ((f = fopen(temp, "wb")) != NULL)
+    {
+        written = (fwrite(image, 1, size, f) == size);
+
+        if (fclose(f) != 0)
+            written = 0;
+    }
+
+    if (!written || rename(temp, argv[1]) == -1)
+    {
+        fprintf(stderr, "Falha ao gravar <%s>: %s\n", argv[1], strerror(errno));
+        remove(temp);
+        status = EXIT_FAILURE;
+    }
+    else
+    {
+        header = image;
+        printf("<%s>: %u categoria(s), %u aresta(s), %zu bytes.\n", argv[1], header->categories, header->edges, size);
+    }
+
+    free(temp);
+    free(image);
+
+    return status;
+}
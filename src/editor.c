@@ -0,0 +1,275 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+#include <wctype.h>
+#include <sys/select.h>
+#include <editor.h>
+#include <render.h>
+#include <reader.h>
+#include <probe.h>
+
+#define CLOCK_SIZE 32 /* caracteres do relógio formatado, com folga */
+
+static struct termios cooked; /* modo do terminal fora do editor */
+static int raw = 0;
+
+static void raw_off(void)
+{
+    if (raw)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &cooked);
+        raw = 0;
+    }
+}
+
+static int raw_on(void)
+{ /* sem eco nem linha canônica; <Ctrl-C> chega como byte e é tratado em <editor_read()> */
+    static int registered = 0;
+    struct termios t;
+
+    if (tcgetattr(STDIN_FILENO, &cooked) == -1)
+        return -1;
+
+    t = cooked;
+    t.c_lflag &= ~(ICANON | ECHO | IEXTEN | ISIG);
+    t.c_cc[VMIN] = 1;
+    t.c_cc[VTIME] = 0;
+
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &t) == -1)
+        return -1;
+
+    raw = 1;
+
+    if (!registered)
+        registered = (atexit(raw_off) == 0);
+
+    return 0;
+}
+
+static int wait_key(nsec until)
+{ /* > 0 se há tecla, 0 se <until> chegou antes, -1 em caso de erro */
+    fd_set readfds;
+    struct timespec wait;
+    nsec left = until - timer_now();
+
+    if (left <= 0)
+        return 0;
+
+    FD_ZERO(&readfds);
+    FD_SET(STDIN_FILENO, &readfds);
+
+    wait.tv_sec = left / NSEC_PER_SEC;
+    wait.tv_nsec = left % NSEC_PER_SEC;
+
+    return pselect(STDIN_FILENO + 1, &readfds, NULL, NULL, &wait, NULL);
+}
+
+typedef struct {
+    wchar_t text[READER_LINE + 1];
+    int len;
+    int limit;
+    int escape;     /* 0 fora de sequência de escape; 1 depois de ESC; 2 dentro de "ESC [" */
+    mbstate_t state;
+} line_edit;
+
+enum { EDIT_TYPING, EDIT_DONE, EDIT_EOF, EDIT_INTERRUPT };
+
+static int edit_key(line_edit *e, wchar_t c)
+{
+    if (e->escape == 1)
+    {
+        e->escape = (c == L'[' || c == L'O')? 2: 0;
+        return EDIT_TYPING;
+    }
+
+    if (e->escape == 2)
+    { /* parâmetros até o byte final, de '@' a '~' */
+        if (c >= L'@' && c <= L'~')
+            e->escape = 0;
+        return EDIT_TYPING;
+    }
+
+    switch (c)
+    {
+    case L'\r':
+    case L'\n':
+        return EDIT_DONE;
+    case 0x03: /* Ctrl-C */
+        return EDIT_INTERRUPT;
+    case 0x04: /* Ctrl-D */
+        return (e->len == 0)? EDIT_EOF: EDIT_TYPING;
+    case 0x15: /* Ctrl-U */
+        e->len = 0;
+        break;
+    case 0x08:
+    case 0x7F: /* Backspace */
+        if (e->len > 0)
+            e->len--;
+        break;
+    case 0x1B:
+        e->escape = 1;
+        break;
+    default:
+        if (iswprint(c) && e->len < e->limit)
+            e->text[e->len++] = c;
+    }
+
+    e->text[e->len] = 0;
+
+    return EDIT_TYPING;
+}
+
+static int edit_bytes(line_edit *e, const char *bytes, size_t n, size_t *consumed)
+{ /* decodifica na localidade, guardando sequências multibyte partidas entre leituras; para no <Enter> */
+    wchar_t c;
+    size_t used;
+    int status = EDIT_TYPING;
+
+    *consumed = 0;
+
+    while (n > 0 && status == EDIT_TYPING)
+    {
+        used = mbrtowc(&c, bytes, n, &e->state);
+
+        if (used == (size_t)-2)
+            break;
+
+        if (used == (size_t)-1)
+        { /* byte inválido: descartado */
+            memset(&e->state, 0, sizeof(e->state));
+            used = 1;
+            c = 0;
+        }
+        else if (used == 0)
+            used = 1;
+
+        if (c != 0)
+            status = edit_key(e, c);
+
+        bytes += used;
+        n -= used;
+        *consumed += used;
+    }
+
+    return status;
+}
+
+static void redraw(const line_edit *e, const wchar_t *prompt, const wchar_t *after, nsec left)
+{ /* relógio truncado ao décimo: só muda quando <left> cruza um múltiplo de EDITOR_TICK */
+    size_t size = wcslen(prompt) + CLOCK_SIZE + wcslen(after) + 1; /* do prompt formatado, qualquer que seja o pacote */
+    wchar_t shown[size + READER_LINE];
+    nsec start = probe_start();
+    int n = swprintf(shown, size, L"%S%.1lf%S", prompt, (double)(left / EDITOR_TICK) * EDITOR_TICK / NSEC_PER_SEC, after);
+
+    if (n < 0)
+        n = 0;
+
+    wmemcpy(shown + n, e->text, e->len + 1);
+    render_line(shown);
+
+    probe_end(PROBE_PROMPT, start);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Lê uma linha do terminal até o prazo <deadline>, exibindo <prompt>, os
+ *  segundos restantes e <after> (textos simples, não formatos), seguidos
+ *  do que já foi digitado, com no máximo <limit> caracteres. O que chegar
+ *  depois do <Enter> na mesma leitura (digitado adiante, colado) vai para
+ *  <in>, o leitor de linhas do mesmo descritor, e não se perde.
+ *
+ *  - RETORNO:
+ *
+ *  valores positivos, com a linha em <*line> (alocada em <a>, se não NULL);
+ *
+ *          0, caso o prazo tenha se esgotado;
+ *
+ *         -1, no fim da entrada (<errno> 0) ou em caso de erro.
+ */
+
+int editor_read(arena *a, line_reader *in, const wchar_t *prompt, const wchar_t *after, int limit, const nsec *deadline, wchar_t **line)
+{
+    line_edit e;
+    char bytes[64];
+    nsec now, left, tick, start;
+    ssize_t n = 0;
+    size_t consumed;
+    int status = EDIT_TYPING, ready;
+
+    memset(&e, 0, sizeof(e));
+    e.limit = (limit < READER_LINE)? limit: READER_LINE;
+
+    if (raw_on() == -1)
+        return -1;
+
+    while (status == EDIT_TYPING)
+    {
+        now = timer_now();
+
+        if ((left = *deadline - now) <= 0)
+            break;
+
+        redraw(&e, prompt, after, left);
+
+        tick = left % EDITOR_TICK; /* até o próximo décimo exibido */
+
+        start = probe_start();
+        ready = wait_key(now + (tick? tick: EDITOR_TICK));
+        probe_end(PROBE_WAIT, start);
+
+        if (ready == -1 && errno != EINTR)
+        {
+            n = -1;
+            status = EDIT_EOF;
+        }
+
+        if (ready <= 0)
+            continue;
+
+        start = probe_start();
+
+        if ((n = read(STDIN_FILENO, bytes, sizeof(bytes))) > 0)
+        {
+            status = edit_bytes(&e, bytes, n, &consumed);
+
+            if (status == EDIT_DONE)
+                reader_push(in, bytes + consumed, n - consumed);
+        }
+        else if (n == 0)
+            status = EDIT_EOF;
+        else if (errno != EINTR && errno != EAGAIN)
+            status = EDIT_EOF;
+
+        probe_end(PROBE_DECODE, start);
+    }
+
+    if (status == EDIT_TYPING)
+        redraw(&e, prompt, after, 0); /* o relógio zerado fica na tela */
+
+    render_line_end();
+    raw_off();
+
+    switch (status)
+    {
+    case EDIT_TYPING:
+        return 0;
+    case EDIT_INTERRUPT:
+        raise(SIGINT);
+        /* fall through */
+    case EDIT_EOF:
+        if (n >= 0)
+            errno = 0; /* fim da entrada, não erro */
+        return -1;
+    }
+
+    if ((*line = mem_alloc(a, (e.len + 1) * sizeof(wchar_t))) == NULL)
+        return -1;
+
+    wmemcpy(*line, e.text, e.len + 1);
+
+    return 1;
+}
@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <main.h>
+#include <journal.h>
+
+#define JOURNAL_BUFFER (64 * 1024) /* bytes acumulados antes de cada gravação */
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Abre o diário em <path> para acréscimos, criando-o se não existir.
+ *
+ *  - RETORNO:
+ *
+ *  o diário, ou NULL em caso de erro (ver <errno>); EINVAL se <path> não
+ *  for um diário.
+ */
+
+journal *journal_open(const char *path)
+{
+    journal_header header = {JOURNAL_MAGIC, JOURNAL_VERSION};
+    journal *j = calloc(1, sizeof(journal));
+    struct stat st;
+
+    if (j == NULL)
+        return NULL;
+
+    if ((j->fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644)) == -1 || fstat(j->fd, &st) == -1)
+        goto fail;
+
+    if (st.st_size == 0)
+    {
+        if (write(j->fd, &header, sizeof(header)) != sizeof(header))
+            goto fail;
+    }
+    else if (pread(j->fd, &header, sizeof(header), 0) != sizeof(header) || header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION)
+    {
+        errno = EINVAL;
+        goto fail;
+    }
+
+    if ((j->buffer = malloc(JOURNAL_BUFFER)) == NULL)
+        goto fail;
+
+    j->capacity = JOURNAL_BUFFER;
+
+    return j;
+
+fail:
+    if (j->fd != -1)
+        close(j->fd);
+    free(j);
+    return NULL;
+}
+
+uint64_t journal_new_game(journal *j)
+{ /* único entre processos que escrevem no mesmo diário: segundos, pid e contador */
+    return ((uint64_t)time(NULL) << 32) | ((uint64_t)(getpid() & 0xFFFF) << 16) | (j->games++ & 0xFFFF);
+}
+
+int journal_flush(journal *j)
+{ /* grava os registros acumulados de uma vez; só registros inteiros entram no arquivo */
+    size_t done = 0;
+    ssize_t n;
+
+    while (done < j->used)
+    {
+        if ((n = write(j->fd, j->buffer + done, j->used - done)) == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            memmove(j->buffer, j->buffer + done, j->used - done);
+            j->used -= done;
+            return -1;
+        }
+
+        done += n;
+    }
+
+    j->used = 0;
+
+    return 0;
+}
+
+int journal_close(journal *j)
+{
+    int status;
+
+    if (j == NULL)
+        return 0;
+
+    status = journal_flush(j);
+
+    if (close(j->fd) == -1)
+        status = -1;
+
+    free(j->buffer);
+    free(j);
+
+    return status;
+}
+
+static size_t utf8_size(const wchar_t *s)
+{
+    char scratch[4];
+    size_t size = 0;
+
+    for (; *s != 0; s++)
+        size += utf8_put(scratch, *s);
+
+    return size;
+}
+
+static char *put_utf8(char *dst, const wchar_t *s)
+{
+    for (; *s != 0; s++)
+        dst += utf8_put(dst, *s);
+
+    return dst;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Acrescenta ao diário a rodada <curr_round> de <data>, já pontuada. O
+ *  registro só é gravado no arquivo quando o lote encher ou em
+ *  <journal_flush()>.
+ *
+ *  - RETORNO:
+ *
+ *  0 em caso de sucesso e -1 se faltar memória ou a gravação falhar.
+ */
+
+int journal_round(journal *j, const game_data *data)
+{
+    const wchar_t *category = data->categories[data->categories_sequence[data->curr_round]];
+    size_t size = sizeof(journal_record) + data->number_of_players * sizeof(journal_turn) + utf8_size(category);
+    journal_record *record;
+    journal_turn *turn;
+    struct timespec now;
+    char *text, *grown;
+    int p;
+
+    for (int t = 0; t < data->number_of_players; t++)
+    {
+        p = data->players_sequence[t];
+        size += utf8_size(player_name(data, p)) + data->round_answer[p]->size;
+    }
+
+    size = (size + 7) & ~(size_t)7;
+
+    if (j->used + size > j->capacity && journal_flush(j) == -1)
+        return -1;
+
+    if (size > j->capacity)
+    { /* registro maior que o lote: só com muitos jogadores */
+        if ((grown = realloc(j->buffer, size)) == NULL)
+            return -1;
+
+        j->buffer = grown;
+        j->capacity = size;
+    }
+
+    record = (journal_record *)(j->buffer + j->used);
+    memset(record, 0, size);
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    record->size = size;
+    record->players = data->number_of_players;
+    record->round = data->curr_round;
+    record->game = data->game_id;
+    record->seed = data->seed;
+    record->time = (int64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+    record->letter = data->letters[data->letters_sequence[data->curr_round]];
+    record->category = data->categories_sequence[data->curr_round];
+    record->category_size = utf8_size(category);
+
+    turn = (journal_turn *)(record + 1);
+    text = put_utf8((char *)(turn + data->number_of_players), category);
+
+    for (int t = 0; t < data->number_of_players; t++)
+    {
+        p = data->players_sequence[t];
+
+        turn[t].time = data->turn_time[p];
+        turn[t].score = player_scores(data, p)[data->curr_round];
+        turn[t].player = p;
+        turn[t].name_size = utf8_size(player_name(data, p));
+        turn[t].answer_size = data->round_answer[p]->size;
+
+        text = put_utf8(text, player_name(data, p));
+        memcpy(text, data->round_answer[p]->bytes, turn[t].answer_size);
+        text += turn[t].answer_size;
+    }
+
+    j->used += size;
+
+    return 0;
+}
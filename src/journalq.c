@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <str8.h>
+#include <journal.h>
+
+/*
+ *  Consulta ao diário: <$ ./journalq <diário> [filtros]>
+ *
+ *  O diário é mapeado com <mmap()> e percorrido registro a registro, sem
+ *  cópias. Sem filtros, só o resumo é impresso; com filtros, também as
+ *  rodadas que atendem a todos eles:
+ *
+ *      --partida <id>       rodadas da partida <id>
+ *      --jogador <nome>     rodadas com o jogador <nome>
+ *      --resposta <texto>   rodadas em que alguém respondeu <texto>
+ *
+ *  Nomes e respostas são comparados por inteiro, ignorando a caixa ASCII.
+ */
+
+typedef struct {
+    int any;
+    unsigned long long game;
+    int by_game;
+    const char *player;
+    const char *answer;
+} filter;
+
+static int same_text(const char *text, uint32_t size, const char *wanted)
+{
+    return size == strlen(wanted) && strncasecmp(text, wanted, size) == 0;
+}
+
+static int matches(const filter *f, const journal_record *record)
+{
+    const journal_turn *turn = (const journal_turn *)(record + 1);
+    const char *text = (const char *)(turn + record->players) + record->category_size;
+    int player = (f->player == NULL), answer = (f->answer == NULL);
+
+    if (f->by_game && record->game != f->game)
+        return 0;
+
+    for (int t = 0; t < record->players && !(player && answer); t++)
+    {
+        player = player || same_text(text, turn[t].name_size, f->player);
+        text += turn[t].name_size;
+        answer = answer || same_text(text, turn[t].answer_size, f->answer);
+        text += turn[t].answer_size;
+    }
+
+    return player && answer;
+}
+
+static void print_round(const journal_record *record)
+{
+    const journal_turn *turn = (const journal_turn *)(record + 1);
+    const char *text = (const char *)(turn + record->players);
+    char when[32], letter[8];
+    time_t seconds = record->time / 1000000000LL;
+    struct tm local;
+
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime_r(&seconds, &local));
+
+    letter[utf8_put(letter, record->letter)] = '\0';
+
+    printf("Partida %llu (semente %llu), %dª rodada (%s): letra %s, %.*s\n", (unsigned long long)record->game,
+           (unsigned long long)record->seed, record->round + 1, when, letter, (int)record->category_size, text);
+
+    text += record->category_size;
+
+    for (int t = 0; t < record->players; t++)
+    {
+        printf("\t%2d. %-24.*s %-32.*s %7.3lf s %4d\n", t + 1,
+               (int)turn[t].name_size, text, (int)turn[t].answer_size, text + turn[t].name_size,
+               turn[t].time * 1E-9, turn[t].score);
+
+        text += turn[t].name_size + turn[t].answer_size;
+    }
+
+    putchar('\n');
+}
+
+static int valid(const journal_record *record, size_t left)
+{ /* o registro cabe no que resta do arquivo e nos próprios limites */
+    const journal_turn *turn;
+    size_t size;
+
+    if (left < sizeof(journal_record) || record->size < sizeof(journal_record) || record->size > left || record->size % 8 != 0)
+        return 0;
+
+    size = sizeof(journal_record) + record->players * sizeof(journal_turn) + record->category_size;
+
+    if (size > record->size)
+        return 0;
+
+    turn = (const journal_turn *)(record + 1);
+
+    for (int t = 0; t < record->players; t++)
+        if ((size += (size_t)turn[t].name_size + turn[t].answer_size) > record->size)
+            return 0;
+
+    return 1;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+int main(int argc, char *argv[])
+{
+    filter f = {0, 0, 0, NULL, NULL};
+    unsigned long long games = 0, rounds = 0, turns = 0, matched = 0;
+    const journal_header *header;
+    const journal_record *record;
+    const char *image;
+    struct stat st;
+    size_t offset;
+    double start, elapsed;
+    int fd;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--partida") == 0 && i + 1 < argc)
+            f.game = strtoull(argv[++i], NULL, 10), f.by_game = 1;
+        else if (strcmp(argv[i], "--jogador") == 0 && i + 1 < argc)
+            f.player = argv[++i];
+        else if (strcmp(argv[i], "--resposta") == 0 && i + 1 < argc)
+            f.answer = argv[++i];
+        else
+            argc = 0; /* uso inválido */
+    }
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s <diário> [--partida <id>] [--jogador <nome>] [--resposta <texto>]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    f.any = f.by_game || f.player != NULL || f.answer != NULL;
+
+    if ((fd = open(argv[1], O_RDONLY)) == -1 || fstat(fd, &st) == -1)
+    {
+        fprintf(stderr, "Falha ao abrir <%s>: %s\n", argv[1], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if (st.st_size < sizeof(journal_header) ||
+        (image = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    {
+        fprintf(stderr, "<%s> não é um diário.\n", argv[1]);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    close(fd);
+    madvise((void *)image, st.st_size, MADV_SEQUENTIAL);
+
+    header = (const journal_header *)image;
+
+    if (header->magic != JOURNAL_MAGIC || header->version != JOURNAL_VERSION)
+    {
+        fprintf(stderr, "<%s> não é um diário.\n", argv[1]);
+        munmap((void *)image, st.st_size);
+        return EXIT_FAILURE;
+    }
+
+    start = now();
+
+    for (offset = sizeof(journal_header); offset < st.st_size; offset += record->size)
+    {
+        record = (const journal_record *)(image + offset);
+
+        if (!valid(record, st.st_size - offset))
+        { /* gravação interrompida no meio de um lote */
+            fprintf(stderr, "Registro inválido na posição %zu; o restante é ignorado.\n", offset);
+            break;
+        }
+
+        rounds++;
+        turns += record->players;
+        games += (record->round == 0);
+
+        if (f.any && matches(&f, record))
+        {
+            matched++;
+            print_round(record);
+        }
+    }
+
+    elapsed = now() - start;
+
+    printf("<%s>: %llu partida(s), %llu rodada(s), %llu turno(s), %lld bytes",
+           argv[1], games, rounds, turns, (long long)st.st_size);
+
+    if (f.any)
+        printf("; %llu rodada(s) atendem aos filtros", matched);
+
+    printf(".\nVarredura: %.3lf ms (%.0lf rodadas/s).\n", elapsed * 1E3, rounds / elapsed);
+
+    munmap((void *)image, st.st_size);
+
+    return EXIT_SUCCESS;
+}
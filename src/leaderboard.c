@@ -0,0 +1,448 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <main.h>
+#include <leaderboard.h>
+
+#define RECORD_OFFSET(i) ((off_t)sizeof(leaderboard_header) + (off_t)(i) * sizeof(player_stats))
+
+static int pread_all(int fd, void *buffer, size_t n, off_t offset)
+{
+    ssize_t done;
+
+    while (n > 0)
+    {
+        if ((done = pread(fd, buffer, n, offset)) <= 0)
+        {
+            if (done == -1 && errno == EINTR)
+                continue;
+            if (done == 0)
+                errno = EINVAL; /* arquivo encurtado */
+            return -1;
+        }
+
+        buffer = (char *)buffer + done;
+        offset += done;
+        n -= done;
+    }
+
+    return 0;
+}
+
+static int pwrite_all(int fd, const void *buffer, size_t n, off_t offset)
+{
+    ssize_t done;
+
+    while (n > 0)
+    {
+        if ((done = pwrite(fd, buffer, n, offset)) == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        buffer = (const char *)buffer + done;
+        offset += done;
+        n -= done;
+    }
+
+    return 0;
+}
+
+static void put_name(char dst[LEADERBOARD_NAME], const wchar_t *name, int folded)
+{ /* <name> em UTF-8, truncado num limite de caractere; dobrado se <folded> */
+    char c[4];
+    int size = 0, n;
+
+    for (; *name != 0; name++)
+    {
+        n = utf8_put(c, folded? fold_char(*name): *name);
+
+        if (size + n >= LEADERBOARD_NAME)
+            break;
+
+        memcpy(dst + size, c, n);
+        size += n;
+    }
+
+    memset(dst + size, 0, LEADERBOARD_NAME - size);
+}
+
+static unsigned hash_key(const char *key)
+{ /* FNV-1a */
+    unsigned h = 2166136261u;
+
+    for (; *key != '\0'; key++)
+        h = (h ^ (unsigned char)*key) * 16777619u;
+
+    return h;
+}
+
+/* ordem */
+
+static int ahead(const void *keys, int a, int b)
+{ /* <a> vem antes de <b> no ranking */
+    const leaderboard *lb = keys;
+    const rank_node *x = &lb->node[a], *y = &lb->node[b];
+
+    if (x->wins != y->wins)
+        return x->wins > y->wins;
+    if (x->points != y->points)
+        return x->points > y->points;
+    if (x->games != y->games)
+        return x->games < y->games;
+
+    return a < b;
+}
+
+static void tree_insert(leaderboard *lb, int i)
+{ /* <i> entra com a ordem de <players[i]> */
+    rank_node *n = &lb->node[i];
+
+    n->points = lb->players[i].points;
+    n->wins = lb->players[i].wins;
+    n->games = lb->players[i].games;
+
+    treap_insert(&lb->order, i);
+}
+
+/* registros */
+
+static int reserve(leaderboard *lb, int n)
+{
+    int capacity = (lb->capacity == 0)? 64: lb->capacity;
+    void *p;
+
+    if (n <= lb->capacity)
+        return 0;
+
+    while (capacity < n)
+        capacity *= 2;
+
+#define GROW(field)                                                             \
+    if ((p = realloc(lb->field, capacity * sizeof(*lb->field))) == NULL)       \
+        return -1;                                                             \
+    lb->field = p;
+
+    GROW(players)
+    GROW(node)
+    GROW(order.node)
+    GROW(dirty)
+    GROW(is_dirty)
+
+#undef GROW
+
+    memset(lb->is_dirty + lb->capacity, 0, capacity - lb->capacity);
+    lb->capacity = capacity;
+
+    return 0;
+}
+
+static void slot_insert(name_slot *slot, int slots, uint32_t hash, int player)
+{ /* <player> é o índice + 1 */
+    unsigned mask = slots - 1, h = hash & mask;
+
+    while (slot[h].player != 0)
+        h = (h + 1) & mask;
+
+    slot[h].hash = hash;
+    slot[h].player = player;
+}
+
+static void hash_insert(leaderboard *lb, int i)
+{
+    slot_insert(lb->slot, lb->slots, hash_key(lb->players[i].key), i + 1);
+}
+
+static int rehash(leaderboard *lb, int n)
+{ /* mantém a tabela de dispersão no máximo meio cheia com <n> registros; sem memória, fica a atual */
+    int slots = (lb->slots == 0)? 128: lb->slots;
+    name_slot *grown;
+
+    if (2 * n <= lb->slots)
+        return 0;
+
+    while (2 * n > slots)
+        slots *= 2;
+
+    if ((grown = calloc(slots, sizeof(name_slot))) == NULL)
+        return -1;
+
+    for (int i = 0; i < lb->count; i++)
+        slot_insert(grown, slots, hash_key(lb->players[i].key), i + 1);
+
+    free(lb->slot);
+    lb->slot = grown;
+    lb->slots = slots;
+
+    return 0;
+}
+
+static int find_key(const leaderboard *lb, const char *key)
+{
+    unsigned mask = lb->slots - 1, hash = hash_key(key), h;
+    const name_slot *slot;
+
+    if (lb->slots == 0)
+        return -1;
+
+    for (h = hash & mask; (slot = &lb->slot[h])->player != 0; h = (h + 1) & mask)
+        if (slot->hash == hash && strcmp(lb->players[slot->player - 1].key, key) == 0)
+            return slot->player - 1;
+
+    return -1;
+}
+
+static void mark(leaderboard *lb, int i)
+{
+    if (!lb->is_dirty[i])
+    {
+        lb->is_dirty[i] = 1;
+        lb->dirty[lb->dirty_count++] = i;
+    }
+}
+
+static int add_player(leaderboard *lb, const wchar_t *name)
+{ /* novo registro, zerado e ainda fora da treap */
+    player_stats *s;
+
+    if (reserve(lb, lb->count + 1) == -1 || rehash(lb, lb->count + 1) == -1)
+        return -1;
+
+    s = &lb->players[lb->count];
+    memset(s, 0, sizeof(*s));
+    put_name(s->name, name, 0);
+    put_name(s->key, name, 1);
+
+    hash_insert(lb, lb->count);
+
+    return lb->count++;
+}
+
+static int category_slot(leaderboard *lb, const wchar_t *category)
+{ /* posição de <category> em <header.category>, acrescentada se couber */
+    char name[LEADERBOARD_NAME];
+    leaderboard_header *h = &lb->header;
+    int c;
+
+    put_name(name, category, 0);
+
+    for (c = 0; c < h->categories; c++)
+        if (strcmp(h->category[c], name) == 0)
+            return c;
+
+    if (c == LEADERBOARD_CATEGORIES)
+        return -1;
+
+    memcpy(h->category[c], name, LEADERBOARD_NAME);
+    h->categories++;
+    lb->header_dirty = 1;
+
+    return c;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Abre o ranking em <path>, criando-o se não existir, e carrega todos os
+ *  registros. O arquivo fica travado (<flock()>) até <leaderboard_close()>,
+ *  de modo que só um processo o atualize.
+ *
+ *  - RETORNO:
+ *
+ *  o ranking, ou NULL em caso de erro (ver <errno>); EINVAL se <path> não
+ *  for um ranking e EWOULDBLOCK se estiver em uso.
+ */
+
+leaderboard *leaderboard_open(const char *path)
+{
+    leaderboard *lb = calloc(1, sizeof(leaderboard));
+    struct stat st;
+    int count;
+
+    if (lb == NULL)
+        return NULL;
+
+    treap_init(&lb->order, NULL, ahead, lb); /* as chaves ficam em <node>, realocado com os registros */
+
+    if ((lb->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644)) == -1 ||
+        flock(lb->fd, LOCK_EX | LOCK_NB) == -1 || fstat(lb->fd, &st) == -1)
+        goto fail;
+
+    if (st.st_size == 0)
+    {
+        lb->header.magic = LEADERBOARD_MAGIC;
+        lb->header.version = LEADERBOARD_VERSION;
+
+        if (pwrite_all(lb->fd, &lb->header, sizeof(lb->header), 0) == -1)
+            goto fail;
+
+        return lb;
+    }
+
+    if (pread_all(lb->fd, &lb->header, sizeof(lb->header), 0) == -1 || lb->header.magic != LEADERBOARD_MAGIC ||
+        lb->header.version != LEADERBOARD_VERSION || lb->header.categories > LEADERBOARD_CATEGORIES ||
+        (st.st_size - sizeof(leaderboard_header)) % sizeof(player_stats) != 0)
+    {
+        errno = EINVAL;
+        goto fail;
+    }
+
+    count = (st.st_size - sizeof(leaderboard_header)) / sizeof(player_stats);
+
+    if (reserve(lb, count) == -1 || pread_all(lb->fd, lb->players, count * sizeof(player_stats), RECORD_OFFSET(0)) == -1)
+        goto fail;
+
+    lb->count = count;
+
+    if (rehash(lb, count) == -1)
+        goto fail;
+
+    for (int i = 0; i < count; i++)
+        tree_insert(lb, i);
+
+    return lb;
+
+fail:
+    if (lb->fd != -1)
+        close(lb->fd);
+    free(lb->players);
+    free(lb->node);
+    free(lb->order.node);
+    free(lb->dirty);
+    free(lb->is_dirty);
+    free(lb->slot);
+    free(lb);
+    return NULL;
+}
+
+int leaderboard_find(const leaderboard *lb, const wchar_t *name)
+{ /* índice do registro de <name>, ou -1 */
+    char key[LEADERBOARD_NAME];
+
+    put_name(key, name, 1);
+
+    return find_key(lb, key);
+}
+
+int leaderboard_rank(const leaderboard *lb, int player)
+{ /* posição de <player> no ranking, a partir de 1 */
+    return treap_rank(&lb->order, player);
+}
+
+int leaderboard_top(const leaderboard *lb, int k, int *out)
+{ /* os <k> primeiros em <out>, em ordem; retorna quantos são */
+    return treap_top(&lb->order, k, out);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Acrescenta ao ranking os jogadores humanos da partida encerrada em
+ *  <data>, vencida por <winner>. Só a memória é alterada; os registros vão para o arquivo em
+ *  <leaderboard_flush()>.
+ *
+ *  - RETORNO:
+ *
+ *  0 em caso de sucesso e -1 se faltar memória.
+ */
+
+int leaderboard_game(leaderboard *lb, const game_data *data, int winner)
+{
+    int category[data->rounds];
+    player_stats *s;
+    const int *row;
+    int i, c;
+
+    for (c = 0; c < data->rounds; c++)
+        category[c] = category_slot(lb, data->categories[data->categories_sequence[c]]);
+
+    for (int p = 0; p < data->number_of_players - data->bots; p++)
+    { /* robôs ficam de fora do ranking */
+        if ((i = leaderboard_find(lb, player_name(data, p))) != -1)
+            treap_erase(&lb->order, i);
+        else if ((i = add_player(lb, player_name(data, p))) == -1)
+            return -1;
+
+        s = &lb->players[i];
+        s->games++;
+        s->wins += (p == winner);
+        s->turns += data->rounds;
+        s->time += data->time_used[p];
+        s->points += data->total[p];
+
+        for (c = 0, row = player_scores(data, p); c < data->rounds; c++)
+        {
+            if (category[c] != -1)
+            {
+                s->category[category[c]].rounds++;
+                s->category[category[c]].hits += (row[c] > 0);
+                s->category[category[c]].points += row[c];
+            }
+        }
+
+        tree_insert(lb, i);
+        mark(lb, i);
+    }
+
+    return 0;
+}
+
+int leaderboard_flush(leaderboard *lb)
+{ /* grava o cabeçalho, se mudou, e os registros alterados */
+    int i;
+
+    if (lb->header_dirty)
+    {
+        if (pwrite_all(lb->fd, &lb->header, sizeof(lb->header), 0) == -1)
+            return -1;
+
+        lb->header_dirty = 0;
+    }
+
+    for (int d = 0; d < lb->dirty_count; d++)
+    { /* na ordem em que foram marcados: registros novos não deixam buracos */
+        i = lb->dirty[d];
+
+        if (pwrite_all(lb->fd, &lb->players[i], sizeof(player_stats), RECORD_OFFSET(i)) == -1)
+        {
+            memmove(lb->dirty, lb->dirty + d, (lb->dirty_count - d) * sizeof(int));
+            lb->dirty_count -= d;
+            return -1;
+        }
+
+        lb->is_dirty[i] = 0;
+    }
+
+    lb->dirty_count = 0;
+
+    return 0;
+}
+
+int leaderboard_close(leaderboard *lb)
+{
+    int status;
+
+    if (lb == NULL)
+        return 0;
+
+    status = leaderboard_flush(lb);
+
+    if (close(lb->fd) == -1)
+        status = -1;
+
+    free(lb->players);
+    free(lb->node);
+    free(lb->order.node);
+    free(lb->dirty);
+    free(lb->is_dirty);
+    free(lb->slot);
+    free(lb);
+
+    return status;
+}
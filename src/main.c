@@ -8,6 +8,14 @@
 #include <stdarg.h>
 #include <errno.h>
 #include <wctype.h>
+#include <string.h>
+#include <unistd.h>
+#include <server.h>
+#include <sim.h>
+#include <pool.h>
+#include <reader.h>
+#include <probe.h>
+#include <editor.h>
 
 /*
  *  - PROPÓSITO:
@@ -16,34 +24,45 @@
  * 
  *  - PARÂMETROS:
  *  
- *  <timeout> aponta para struct <timeval> de atributos
- *  <tv_sec> e <tv_usec>, que, respectivamente,
- *  representam segundos e microssegundos a serem esperados.
+ *  <deadline> aponta para o prazo (ver <set_time()>) até o qual se espera,
+ *  ou é NULL para esperar indefinidamente. O tempo restante é recalculado
+ *  a partir do prazo a cada chamada, que por isso pode se repetir à vontade.
  * 
  *  - RETORNO:
  * 
- *  retorna 0, caso o tempo limite seja ultrapassado;
+ *  retorna 0, caso o prazo tenha se esgotado;
  *
- *         -1, caso <timeout> passado seja inválido ou ocorra algum outro erro
- *  durante a execução de <select()>, especificado pela variável <errno>;
+ *         -1, caso ocorra algum erro durante a execução de <pselect()>,
+ *  especificado pela variável <errno>;
  *
  *          valores positivos, caso <stdin> tenha sido alterado.
  */
 
-int await_input(time_data *timeout)
+int await_input(time_data *deadline)
 {
     fd_set readfds; /* file descriptor de <stdin> */
+    struct timespec wait;
+    nsec left;
 
     FD_ZERO(&readfds);               /* inicializando-o */
     FD_SET(fileno(stdin), &readfds); /* associando-o a <stdin> */
 
-    return select(1, &readfds, NULL, NULL, timeout); /* aguarda modificação da entrada */
+    if (deadline == NULL)
+        return pselect(1, &readfds, NULL, NULL, NULL, NULL);
+
+    if ((left = *deadline - timer_now()) <= 0)
+        return 0;
+
+    wait.tv_sec = left / NSEC_PER_SEC;
+    wait.tv_nsec = left % NSEC_PER_SEC;
+
+    return pselect(1, &readfds, NULL, NULL, &wait, NULL); /* aguarda modificação da entrada */
 }
 
-wchar_t *read_up_to(FILE *f, wint_t terminator)
+wchar_t *read_up_to(arena *a, FILE *f, wint_t terminator)
 { /* returns text section up to <terminator>, not including it, or EOF */
-    int i = 0, s = 128;
-    wchar_t *buffer = malloc(s * WCHAR_SIZE), *temp_buffer;
+    size_t i = 0, s = 128;
+    wchar_t *buffer = mem_alloc(a, s * WCHAR_SIZE), *temp_buffer;
     wint_t c;
 
     if (buffer != NULL)
@@ -54,14 +73,14 @@ wchar_t *read_up_to(FILE *f, wint_t terminator)
 
             if (i == s - 1)
             {
-                s += 128;
-                temp_buffer = realloc(buffer, s * WCHAR_SIZE);
+                temp_buffer = mem_grow(a, buffer, s * WCHAR_SIZE, 2 * s * WCHAR_SIZE);
                 if (temp_buffer == NULL)
                 {
-                    free(buffer);
+                    mem_free(a, buffer);
                     return NULL;
                 }
                 buffer = temp_buffer;
+                s *= 2;
             }
 
             buffer[i] = c;
@@ -74,9 +93,74 @@ wchar_t *read_up_to(FILE *f, wint_t terminator)
     return buffer;
 }
 
-wchar_t *read_line(FILE *f)
+wchar_t *read_line(arena *a, FILE *f)
 {
-    return read_up_to(f, L'\n');
+    return read_up_to(a, f, L'\n');
+}
+
+static line_reader input; /* <stdin>, lido direto do descritor, sem o buffer de <stdio> */
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Obtém a próxima linha de <stdin> dentro do prazo <timeout> (NULL para
+ *  esperar indefinidamente), guardando no máximo <limit> caracteres; se a
+ *  linha for maior, <input.overflow> é marcado e o excedente, descartado.
+ *  Linhas com bytes inválidos na localidade são recusadas e ignoradas.
+ *
+ *  - RETORNO:
+ *
+ *  valores positivos, com a linha em <*line> (alocada em <a>, se não NULL);
+ *
+ *          0, caso o prazo tenha se esgotado;
+ *
+ *         -1, no fim da entrada (<errno> 0) ou em caso de erro.
+ */
+
+int get_line(arena *a, int limit, time_data *timeout, wchar_t **line)
+{
+    wchar_t raw[READER_LINE];
+    int input_status, size;
+    nsec start;
+
+    for (;;)
+    {
+        while (!reader_next(&input, limit))
+        {
+            if (input.eof)
+            {
+                errno = 0;
+                return -1;
+            }
+
+            start = probe_start();
+            input_status = await_input(timeout);
+            probe_end(PROBE_WAIT, start);
+
+            if (input_status <= 0)
+                return input_status;
+
+            if (reader_fill(&input) == -1 && errno != EINTR && errno != EAGAIN)
+                return -1;
+        }
+
+        start = probe_start();
+        size = reader_decode(&input, raw);
+        probe_end(PROBE_DECODE, start);
+
+        if (size != -1)
+            break;
+
+        fputws(L"\n\tEntrada inválida!\n\n", screen);
+        render_present();
+    }
+
+    if ((*line = mem_alloc(a, (size + 1) * WCHAR_SIZE)) == NULL)
+        return -1;
+
+    wmemcpy(*line, raw, size + 1);
+
+    return 1;
 }
 
 /*
@@ -89,134 +173,51 @@ long long get_int(long long min, long long max, time_data *timeout)
     long long n;
     wchar_t *s;
 
-    while ((input_status = await_input(timeout)) > 0)
+    while ((input_status = get_line(NULL, READER_LINE, timeout, &s)) > 0)
     {
-        s = read_line(stdin);
-
-        if (s == NULL)
-        {
-            timeout->tv_sec = 0;
-            timeout->tv_usec = 0;
-
-            return -1;
-        }
+        render_echo(s);
 
         conversion_status = swscanf(s, L"%lld", &n);
 
         free(s);
 
-        if (conversion_status == 1 && min <= n && n <= max)
+        if (conversion_status == 1 && !input.overflow && min <= n && n <= max)
             return n;
         else
         {
-            fputws(L"\n\tEntrada inválida ou fora do intervalo esperado!\n\nDigite inteiro", stdout);
+            fputws(L"\n\tEntrada inválida ou fora do intervalo esperado!\n\nDigite inteiro", screen);
 
             if (min == LLONG_MIN && max == LLONG_MAX)
-                fputws(L": ", stdout);
+                fputws(L": ", screen);
             else if (max == LLONG_MAX)
-                wprintf(L" superior a %lld: ", min);
+                fwprintf(screen, L" superior a %lld: ", min);
             else if (min == LLONG_MIN)
-                wprintf(L" inferior a %lld: ", max);
+                fwprintf(screen, L" inferior a %lld: ", max);
             else
-                wprintf(L" em [%lld, %lld]: ", min, max);
-            fflush(stdout);
+                fwprintf(screen, L" em [%lld, %lld]: ", min, max);
+            render_present();
         }
     }
 
-    return input_status; /* if timeout expires, timeout fields and return value are all 0;
-        whenever error occurrs, timeout fields are set to 0 and -1 is returned,
+    if (input_status == -1 && timeout != NULL)
+        *timeout = 0; /* prazo já vencido */
+
+    return input_status; /* if timeout expires, return value is 0;
+        whenever error occurrs, the deadline is set to the past and -1 is returned,
         the reason should be found by checking the corresponding <errno> value.
     */
 }
 
-wchar_t *trim_wstring(wchar_t const *s)
-{
-    int i = 0; /* current <s> index */
-    int j = 0; /* current <trimmed> index */
-    int n = 128;
-    wchar_t *trimmed = malloc(n * WCHAR_SIZE), *temp_trimmed; /* trimmed string */
-
-    if (trimmed != NULL)
-    {
-        /* skip left-hand spaces */
-        while (s[i] == L' ')
-            i++;
-
-        while (s[i] != 0)
-        {
-            if (s[i] != L' ' || s[i - 1] != L' ')
-            {
-                if (j == n - 1)
-                {
-                    n += 128;
-                    temp_trimmed = realloc(trimmed, n * WCHAR_SIZE);
-
-                    if (temp_trimmed == NULL)
-                    {
-                        free(trimmed);
-                        return NULL;
-                    }
-
-                    trimmed = temp_trimmed;
-                }
-                trimmed[j] = s[i];
-                j++;
-            }
-
-            i++;
-        }
-
-        if (j > 0 && trimmed[j - 1] == L' ')
-            j--;
-
-        trimmed[j] = 0;
-
-        temp_trimmed = realloc(trimmed, (j + 1) * WCHAR_SIZE);
-
-        if (temp_trimmed != NULL)
-            trimmed = temp_trimmed;
-    }
-
-    return trimmed;
-}
-
-int wstr_size(wchar_t const *s)
-{
-    int i = 0;
-
-    while (s[i] != 0)
-        i++;
-
-    return i;
-}
-
-int wstr_find(wchar_t const *s, wchar_t c)
-{
-    int i = 0;
-
-    while (s[i] != 0 && s[i] != c)
-        i++;
-
-    if (s[i] == 0)
-        i = -1;
-
-    return i;
-}
-
-int validate_answer(wchar_t *answer, unsigned long long min_size, unsigned long long max_size)
-{
-    int size_answer = wstr_size(answer);
-
+int validate_size(FILE *stream, int size_answer, unsigned long long min_size, unsigned long long max_size)
+{ /* escreve o motivo em <stream> se <size_answer> estiver fora dos limites */
     if (size_answer < min_size || size_answer > max_size)
     {
-        free(answer);
-
         if (size_answer > max_size)
-            wprintf(L"\n\tEntrada não deve exceder %d caracteres!\n\n", max_size);
+            fwprintf(stream, L"\n\tEntrada não deve exceder %d caracteres!\n\n", max_size);
         else if (min_size == 1)
-            putws(L"\n\tEntrada vazia!\n");
+            fputws(L"\n\tEntrada vazia!\n\n", stream);
         else
-            wprintf(L"\n\tInsira ao menos %d caracteres!\n\n", min_size);
+            fwprintf(stream, L"\n\tInsira ao menos %d caracteres!\n\n", min_size);
 
         // putws("\n\tOBS: espaços extremos são ignorados e os internos contíguos contados única vez.");
 
@@ -226,6 +227,16 @@ int validate_answer(wchar_t *answer, unsigned long long min_size, unsigned long
         return 1;
 }
 
+int validate_answer(FILE *stream, arena *a, wchar_t *answer, unsigned long long min_size, unsigned long long max_size)
+{
+    if (validate_size(stream, wstr_size(answer), min_size, max_size))
+        return 1;
+
+    mem_free(a, answer);
+
+    return 0;
+}
+
 wchar_t *fget_input(unsigned long long min_size, unsigned long long max_size, time_data *timeout, wchar_t *format, ...)
 { /* aks for input until gets answer within size constraint or timeout is elapsed;
     for undefined lim, pass <ULLONG_MAX> from <limits.h> as second argument  */
@@ -239,205 +250,180 @@ wchar_t *fget_input(unsigned long long min_size, unsigned long long max_size, ti
 
         va_start(ap, format);
 
-        prompt = vfwstring(format, ap);
+        prompt = vfwstring(NULL, format, ap);
 
         if (prompt == NULL)
             return NULL;
 
-        fputws(prompt, stdout);
+        fputws(prompt, screen);
 
-        fflush(stdout);
+        render_present();
 
         free(prompt);
 
-        input_status = await_input(timeout);
+        input_status = get_line(NULL, (max_size < READER_LINE)? max_size: READER_LINE, timeout, &raw_anwser);
 
         if (input_status <= 0)
-            return NULL; /* time expired (input_status == 0) or <select()> failed (input_status == -1) (check <errno>)*/
-
-        raw_anwser = read_line(stdin);
+            return NULL; /* time expired (input_status == 0), input ended or failed (input_status == -1) (check <errno>)*/
 
-        if (raw_anwser == NULL) /* unable to allocate memory to store line (errno == ENOMEM) */
-            return NULL;
+        render_echo(raw_anwser);
 
-        answer = trim_wstring(raw_anwser);
+        answer = trim_wstring(NULL, raw_anwser);
 
         free(raw_anwser);
 
-    } while (!validate_answer(answer, min_size, max_size));
+        if (input.overflow)
+        {
+            fwprintf(screen, L"\n\tEntrada não deve exceder %d caracteres!\n\n", max_size);
+            free(answer);
+            answer = NULL;
+        }
+
+    } while (answer == NULL || !validate_answer(screen, NULL, answer, min_size, max_size));
 
     va_end(ap);
 
     return answer;
 }
 
-wchar_t *get_input(wchar_t *prompt, unsigned long long min_size, unsigned long long max_size, time_data *timeout, int flush)
+wchar_t *get_input(arena *a, const wchar_t *prompt, const wchar_t *after, unsigned long long min_size, unsigned long long max_size, time_data *timeout, int flush)
 {
     /* aks for input until gets answer within size constraint or timeout is elapsed;
-    for undefined lim, pass <ULLONG_MAX> from <limits.h> as second argument  */
+    for undefined lim, pass <ULLONG_MAX> from <limits.h> as second argument;
+    with <timeout>, the seconds left are shown between <prompt> and <after>,
+    both plain text, never used as formats */
     wchar_t *raw_anwser, *answer;
-    int input_status;
+    int input_status, live, overflow;
+    nsec start;
 
     do
     {
-        if (timeout == NULL)
-            fputws(prompt, stdout);
+        /* com prazo, num terminal e sem linhas já digitadas à espera, o relógio corre enquanto se digita */
+        live = (timeout != NULL && render_interactive() && input.head == input.tail);
+
+        if (live)
+        {
+            input_status = editor_read(a, &input, prompt, after, (max_size < READER_LINE)? max_size: READER_LINE, timeout, &raw_anwser);
+            overflow = 0; /* o editor não aceita além do limite */
+        }
         else
-            wprintf(prompt, time_left(*timeout));
+        {
+            start = probe_start();
 
-        fflush(stdout);
+            if (timeout == NULL)
+                fputws(prompt, screen);
+            else
+                fwprintf(screen, L"%S%.1lf%S", prompt, time_left(*timeout), after);
 
-        input_status = await_input(timeout);
+            render_present();
+            probe_end(PROBE_PROMPT, start);
 
-        if (input_status <= 0)
-            return NULL; /* time expired (input_status == 0) or <select()> failed (input_status == -1) (check <errno>)*/
+            input_status = get_line(a, (max_size < READER_LINE)? max_size: READER_LINE, timeout, &raw_anwser);
+            overflow = input.overflow;
+        }
 
-        raw_anwser = read_line(stdin);
+        if (input_status <= 0)
+            return NULL; /* time expired (input_status == 0), input ended or failed (input_status == -1) (check <errno>)*/
 
-        if (raw_anwser == NULL) /* unable to allocate memory to store line (errno == ENOMEM) */
-            return NULL;
+        if (!live)
+            render_echo(raw_anwser);
 
-        answer = trim_wstring(raw_anwser);
+        start = probe_start();
+        answer = trim_wstring(a, raw_anwser);
+        probe_end(PROBE_TRIM, start);
 
-        free(raw_anwser);
+        mem_free(a, raw_anwser); /* na região, só é devolvida se <answer> não tiver sido alocada */
 
         if (flush)
             clear();
 
-    } while (!validate_answer(answer, min_size, max_size));
-
-    return answer;
-}
-
-wchar_t *vfwstring(const wchar_t *format, va_list ap)
-{
-    wchar_t *mem_buffer, *s = NULL;
-    size_t mem_size;
-    FILE *mem_stream = open_wmemstream(&mem_buffer, &mem_size);
-
-    int operation_status;
-
-    if (mem_stream == NULL)
-        return NULL;
-
-    // va_start(ap, format);
-
-    operation_status = vfwprintf(mem_stream, format, ap);
-
-    if (operation_status != -1)
-    {
-        s = read_up_to(mem_stream, WEOF);
-    }
-
-    fclose(mem_stream);
-    free(mem_buffer);
-
-    return s;
-}
-
-wchar_t *fwstring(const wchar_t *format, ...)
-{
-    wchar_t *s = NULL;
-
-    va_list ap;
-
-    va_start(ap, format);
-
-    s = vfwstring(format, ap);
+        if (overflow)
+        { /* nem chega a ser guardada por inteiro */
+            fwprintf(screen, L"\n\tEntrada não deve exceder %d caracteres!\n\n", max_size);
+            mem_free(a, answer);
+            answer = NULL;
+        }
 
-    va_end(ap);
+    } while (answer == NULL || !validate_answer(screen, a, answer, min_size, max_size));
 
-    return s;
+    return answer;
 }
 
-int get_names(game_data *data)
-{
+int get_names(game_data *data, wchar_t **names)
+{ /* só os humanos: os robôs são nomeados em <init_game()> */
     int i;
     wchar_t *name, *prompt;
 
-    data->player_name = malloc(sizeof(wchar_t *) * data->number_of_players);
-
-    if (data->player_name == NULL)
-        return -1;
-
-    for (i = 0; i < data->number_of_players; i++)
+    for (i = 0; i < data->number_of_players - data->bots; i++)
     {
-        prompt = fwstring(L"\nNome do jogador %02d: ", i + 1);
-        name = get_input(prompt, 1, data->name_size, NULL, 0);
+        prompt = fwstring(NULL, L"\nNome do jogador %02d: ", i + 1);
+        name = get_input(NULL, prompt, NULL, 1, data->name_size, NULL, 0);
         free(prompt);
 
         if (name == NULL)
             return -1;
 
-        data->player_name[i] = name;
+        names[i] = name;
     }
 
     return 0; /* job done */
 }
 
-void swap_int(int *a, int *b)
-{
-    int temp = *a;
-    *a = *b;
-    *b = temp;
-}
-
-int rand_int(int lower_bound, int upper_bound)
-{ /* returns random integer in [lower_bound, upper_bound) */
+static void draw_sequence(rng *g, int *sequence, int length, int range)
+{ /* <length> índices em [0, range), em blocos de permutações: sem repetição até esgotá-los */
+    int block[range];
 
-    return rand() % (upper_bound - lower_bound) + lower_bound;
+    for (int start = 0; start < length; start += range)
+    {
+        if (length - start >= range)
+            rng_permutation(g, sequence + start, range);
+        else
+        {
+            rng_permutation(g, block, range);
+            memcpy(sequence + start, block, (length - start) * sizeof(int));
+        }
+    }
 }
 
-int *ascending_sequence(int n) {
-    int *A = calloc(n, sizeof(int));
-
-    for (int i = 0; i < n; i++) A[i] = i;
-
-    return A;
+void draw_turn_order(game_data *data)
+{ /* ordem da rodada, sorteada no lugar em <players_sequence> */
+    rng_permutation(&data->rng, data->players_sequence, data->number_of_players);
 }
 
-int *index_permutation(int n)
-{ /* Fisher-Yates shuffle */
-    int i, r, *indices;
-
-    if (n <= 0)
-        return NULL;
-
-    indices = ascending_sequence(n);
-
-    for (i = 0; i < n - 1; i++)
-    {
-        r = rand_int(i, n);
-        swap_int(&indices[i], &indices[r]);
-    }
-
-    return indices;
+void seat_order(game_data *data)
+{ /* ordem dos assentos, para o resultado final */
+    for (int p = 0; p < data->number_of_players; p++)
+        data->players_sequence[p] = p;
 }
 
-void show_players(game_data *data)
-{
-    int i;
-    wchar_t **player = data->player_name;
+void show_players(FILE *stream, game_data *data)
+{ /* nas salas grandes, só o começo da ordem */
+    int i, shown = (data->number_of_players > SCOREBOARD_TOP)? SCOREBOARD_TOP: data->number_of_players;
     int *sequence = data->players_sequence;
-    for (i = 0; i < data->number_of_players; i++)
-    {
-        wprintf(L"\t%2d. %S\n", i + 1, player[sequence[i]]);
-    }
+
+    for (i = 0; i < shown; i++)
+        fwprintf(stream, L"\t%2d. %S\n", i + 1, player_name(data, sequence[i]));
+
+    if (shown < data->number_of_players)
+        fwprintf(stream, L"\t... e mais %d jogadores\n", data->number_of_players - shown);
 }
 
 void set_time(time_data *td, double sec)
-{
-    td->tv_sec = (int)sec;
-    td->tv_usec = (int)round((int)(sec * 1E-6) % ((int)1E6));
+{ /* prazo daqui a <sec> segundos */
+    *td = timer_now() + seconds_to_ns(sec);
 }
 
 double time_left(time_data td)
-{
-    double s;
+{ /* segundos até o prazo <td>, ou 0 se já vencido */
+    nsec left = td - timer_now();
 
-    s = td.tv_sec + td.tv_usec * 1E-6;
+    return (left > 0)? ns_to_seconds(left): 0.0;
+}
 
-    return s;
+void charge_turn(game_data *data, int player, nsec used)
+{ /* registra o tempo do turno de <player> na rodada e no total da partida */
+    data->turn_time[player] = used;
+    data->time_used[player] += used;
 }
 
 double player_total_time(game_data *data)
@@ -457,625 +443,739 @@ double player_total_time(game_data *data)
 
 // }
 
-wchar_t *get_answer(game_data *data)
-{
-    wchar_t *answer;
-    time_data *timeout = &data->curr_time_left;
-
-    int cat_id = data->categories_sequence[data->curr_round];
-
-    wchar_t *name = data->player_name[data->players_sequence[data->curr_turn]];
-    const wchar_t *category = data->categories[cat_id];
-    const wchar_t letter = data->letters[data->letters_sequence[data->curr_round]];
-
-    wchar_t *prompt = fwstring(L"%S, você tem %s segundo(s) para inserir palavra na categoria \"%S\" começando com \"%C\": ", name, "%.2lf", category, letter);
+/*
+ *  Confere se <answer>, já validada quanto ao tamanho, começa com a letra
+ *  da rodada e consta no dicionário da categoria, se houver. Nas
+ *  categorias marcadas no pacote (pessoas) só o primeiro nome é
+ *  considerado, e <answer> é truncada.
+ *  Caso seja recusada, o motivo é escrito em <stream> e 0 é retornado.
+ */
 
-    int first_loop = 1;
+int check_answer(FILE *stream, game_data *data, str8 *answer)
+{
+    int cat_id = data->categories_sequence[data->curr_round], letter_id = data->letters_sequence[data->curr_round];
+    const wchar_t letter = data->letters[letter_id];
 
-    do
+    if (!str8_starts_with(answer, data->config->folded_letters[letter_id]))
     {
-        if (!first_loop) wprintf(L"\n\tA letra da rodada é \"%C\"!!\n\n", letter);
-
-        answer = get_input(prompt, 1, 30, timeout, 1);
-
-        // wprintf(L"time_left(timeout) == %lf", time_left(timeout));
-
-        if (answer == NULL)
-            break; /* if time hasn't expired at this point, error has ocurred; errno should be checked */
-
-        first_loop = 0;
-
-    } while (!starts_with(answer, letter));
-
-    if (cat_id == 0) {
-        int first_space = wstr_find(answer, L' ');
-        
-        if (first_space != -1) {
-            wchar_t *trunc_answer = calloc(first_space + 1, WCHAR_SIZE);
-            
-            trunc_answer[first_space] = L'\0';
+        fwprintf(stream, L"\n\tA letra da rodada é \"%C\"!!\n\n", letter);
+        return 0;
+    }
 
-            while (first_space-- > 0) trunc_answer[first_space] = answer[first_space];             
+    if (data->config->first_word[cat_id])
+        str8_first_word(answer);
 
-            free(answer);
+    if (!dict_contains(data->dictionary, cat_id, answer))
+    {
+        wchar_t shown[answer->length + 1];
 
-            answer = trunc_answer;
-        } 
+        str8_decode(answer, shown);
+        fwprintf(stream, L"\n\t\"%S\" não consta na lista de %S!!\n\n", shown, data->categories[cat_id]);
+        return 0;
     }
 
-    wprintf(L"shit\n");
-
-    free(prompt);
-
-    wprintf(L"shit\n");
+    return 1;
+}
 
-    return answer;
+int is_bot(const game_data *data, int player)
+{
+    return player >= data->number_of_players - data->bots;
 }
 
-/* to fucking hell with this
+/*
+ *  - PROPÓSITO:
+ *
+ *  Jogada do robô da vez, com <budget> segundos para responder (o que
+ *  ainda resta do turno ou, na simulação, o turno inteiro). A resposta
+ *  passa pelas mesmas verificações das digitadas, com os motivos de
+ *  recusa escritos em <stream>.
+ *
+ *  - RETORNO:
+ *
+ *  a resposta, em <round_arena>, a ser dada depois de <*latency>
+ *  segundos; ou NULL se o robô deixar o tempo se esgotar.
+ */
 
-wchar_t *answer_countdown(game_data *data)
+str8 *bot_turn(FILE *stream, game_data *data, double budget, double *latency)
 {
-    wchar_t *raw_answer = fwstring(L"%C", L'\0'), *answer;
-    int const max_size = data->answer_size;
-    double time_left = player_total_time(data);
-    time_t dt;
-
     int cat_id = data->categories_sequence[data->curr_round];
-
-    wchar_t *name = data->player_name[data->players_sequence[data->curr_round]];
-    const wchar_t *category = data->categories[cat_id];
     const wchar_t letter = data->letters[data->letters_sequence[data->curr_round]];
+    wchar_t *typed;
+    str8 *answer;
 
-    putws(L"shit1");
+    typed = bot_answer(&data->round_arena, &data->rng, data->config->bots, data->bot_profile, cat_id, letter, budget, latency);
 
-    wchar_t *template = fwstring(L"%%S%S, você tem %%S segundo(s) para inserir palavra na categoria \"%S\" começando com \"%C\": %%S", name, category, letter), *prompt, *warning;
-    int first_loop = 1, line_break;
-
-    putws(L"shit2");
-
-    // raw_answer = malloc(WCHAR_SIZE);
-    // *raw_answer = 0;
-
-    putws(L"shit3");
-
-    do
+    if (typed == NULL || !validate_answer(stream, &data->round_arena, typed, 1, data->answer_size) ||
+        (answer = str8_from_wide(&data->round_arena, typed)) == NULL || !check_answer(stream, data, answer))
     {
-        line_break = -1;
-
-        // free(read_up_to(stdin, WEOF));
-
-        warning = fwstring(L"%C", L'\0');
-
-        putws(L"shit4");
-
-        if (!first_loop)
-        {
-
-            free(warning);
-            if (answer[0] == letter)
-                warning = fwstring(L"\n\tApenas o primeiro nome!!\n\n");
-            else
-                warning = fwstring(L"\n\tA letra da rodada é \"%C\"!!\n\n", letter);
-        }
-        else
-            first_loop = 0;
-
-        prompt = fwstring(template, warning, L"%.2lf", L"%S");
-
-        free(warning);
+        *latency = budget;
+        return NULL;
+    }
 
-        fflush(stdout);
+    return answer;
+}
 
-        do
-        {
-            dt = -clock();
+static str8 *get_bot_answer(game_data *data, const wchar_t *name)
+{ /* exibe o robô pensando e espera o tempo que ele leva para responder */
+    struct timespec until;
+    double latency;
+    str8 *answer;
+    nsec deadline;
 
-            clear();
+    fwprintf(screen, L"%S está pensando...\n", name);
+    render_present();
 
-            wprintf(L"time_left == %lf\n\n", time_left);
-            
-            wprintf(prompt, time_left, raw_answer);
-            fflush(stdout);
+    answer = bot_turn(screen, data, time_left(data->curr_time_left), &latency);
+    deadline = timer_now() + seconds_to_ns(latency);
 
-            free(raw_answer);
+    if (deadline > data->curr_time_left)
+        deadline = data->curr_time_left;
 
-            wprintf(L"\nbfr read_up_to(stdin, WEOF)\n\n");
-            fflush(stdin);
-            raw_answer = read_up_to(stdin, WEOF);
-            fflush(stdout);
+    until.tv_sec = deadline / NSEC_PER_SEC;
+    until.tv_nsec = deadline % NSEC_PER_SEC;
 
-            wprintf(L"\naftr read_up_to(stdin, WEOF)\n\n");
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+        ;
 
-            if (raw_answer == NULL)
-                return NULL;
+    if (answer != NULL)
+    {
+        wchar_t shown[answer->length + 1];
 
-            line_break = wstr_find(raw_answer, L'\n');
-            wprintf(L"\nline_break == %d\n", line_break);
+        str8_decode(answer, shown);
+        render_echo(shown);
+    }
 
-            dt += clock();
+    return answer;
+}
 
-            time_left -= (((double)dt) / CLOCKS_PER_SEC);
+str8 *get_answer(game_data *data)
+{
+    wchar_t *typed;
+    str8 *answer;
+    time_data *timeout = &data->curr_time_left;
 
-            if (round(time_left * 100) / 100 <= 0)
-            {
-                set_time(&data->curr_time_left, 0);
-                free(raw_answer);
-                return NULL;
-            }
+    int cat_id = data->categories_sequence[data->curr_round];
 
-        } while (line_break == -1);
+    wchar_t *name = player_name(data, data->players_sequence[data->curr_turn]);
+    const wchar_t *category = data->categories[cat_id];
+    const wchar_t letter = data->letters[data->letters_sequence[data->curr_round]];
 
-        raw_answer[line_break] = 0;
+    if (is_bot(data, data->players_sequence[data->curr_turn]))
+        return get_bot_answer(data, name);
 
-        answer = trim_wstring(raw_answer);
+    nsec start = probe_start();
+    /* nomes e categorias vêm de fora (jogadores, pacotes): entram como argumentos, nunca como formato */
+    wchar_t *prompt = fwstring(&data->round_arena, L"%S, você tem ", name);
+    wchar_t *after = fwstring(&data->round_arena, L" segundo(s) para inserir palavra na categoria \"%S\" começando com \"%C\": ", category, letter);
 
-        if (answer == NULL)
-            return NULL;
+    probe_end(PROBE_PROMPT, start);
 
-        free(raw_answer);
+    do
+    {
+        typed = get_input(&data->round_arena, prompt, after, 1, data->answer_size, timeout, 1);
 
-        set_time(&data->curr_time_left, time_left);
+        // wprintf(L"time_left(timeout) == %lf", time_left(timeout));
 
-    } while (!validate_answer(answer, 1, max_size) || answer[0] != letter || (cat_id == 0 && wstr_find(answer, ' ') != -1));
+        if (typed == NULL || (answer = str8_from_wide(&data->round_arena, typed)) == NULL)
+            return NULL; /* if time hasn't expired at this point, error has ocurred; errno should be checked */
 
-    free(prompt);
+    } while (!check_answer(screen, data, answer));
 
     return answer;
-} 
-*/
-
-void show_answers(game_data *data)
-{
-    int i, player;
-    wchar_t *name, *answer;
+}
 
-    wprintf(L"Respostas da %dª Rodada:\n\n", data->curr_round + 1);
+void show_answers(FILE *stream, game_data *data)
+{ /* na ordem da rodada ou, nas salas grandes, só as dos primeiros colocados */
+    int i, player, shown = data->number_of_players, top[SCOREBOARD_TOP];
+    const int *order = data->players_sequence;
+    wchar_t *name;
 
-    for (i = 0; i < data->number_of_players; i++)
+    if (shown > SCOREBOARD_TOP)
     {
-        player = data->players_sequence[i];
-
-        name = data->player_name[player];
-        answer = data->round_answer[player];
-
-        wprintf(L"\t%12S: %S\n", name, answer);
-
-        free(answer);
+        shown = standings_top(&data->standings, SCOREBOARD_TOP, top);
+        order = top;
+        fwprintf(stream, L"Respostas dos %d primeiros colocados na %dª Rodada:\n\n", shown, data->curr_round + 1);
     }
-}
-
-int starts_with(wchar_t *s, wchar_t l)
-{
-    const wchar_t alpha[] = L"AEIOUYBCDFGHJKLMNPQRSTVWXZ";
-    const wchar_t variants[] = L"AÁÀÂÃEÉÈÊEIÍÌÎIOÓÒÔÕUÚÙÛUYÝ";
-
-    int letter = wstr_find(alpha, towupper(l));
-
-    int i;
+    else
+        fwprintf(stream, L"Respostas da %dª Rodada:\n\n", data->curr_round + 1);
 
-    if (letter == -1)
+    for (i = 0; i < shown; i++)
     {
-        letter = wstr_find(variants, towupper(l));
+        player = order[i];
 
-        if (letter == -1)
-            return -1;
+        name = player_name(data, player);
+        wchar_t answer[data->round_answer[player]->length + 1]; /* decodificada só para exibir */
 
-        letter = letter / 5;
-    };
+        str8_decode(data->round_answer[player], answer);
+        fwprintf(stream, L"\t%12S: %S\n", name, answer);
+    }
+}
 
-    if (letter < 6)
-    {
-        i = wstr_find(variants, towupper(s[0]));
+void show_scores(FILE *stream, game_data *data)
+{ /* nas salas grandes, os primeiros colocados, em ordem; ver <show_standing()> */
+    int top[SCOREBOARD_TOP], shown;
+    nsec start = probe_start();
 
-        return (5 * letter <= i && i < 5 * (letter + 1));
-    }
+    if (data->number_of_players <= SCOREBOARD_TOP)
+        scoreboard_render(stream, &data->board, data->players_sequence, data->number_of_players, data->curr_round);
     else
     {
-        return (wstr_find(alpha, towupper(s[0])) == letter);
+        shown = standings_top(&data->standings, SCOREBOARD_TOP, top);
+        scoreboard_render(stream, &data->board, top, shown, data->curr_round);
     }
-}
 
-int fconcat(FILE *stream, wchar_t *start, wchar_t *end)
-{
-    if (fputws(start, stream) == -1)
-        return -1;
-    if (fputws(end, stream) == -1)
-        return -1;
-    return 1;
+    probe_end(PROBE_TABLE, start);
 }
 
-wchar_t *concat(wchar_t *start, wchar_t *end)
-{
-    wchar_t *buffer;
-    size_t len;
-    FILE *mem_stream = open_wmemstream(&buffer, &len);
+void show_standing(FILE *stream, game_data *data, int player)
+{ /* nas salas grandes, a linha de <player> e sua posição, abaixo da tabela */
+    int position;
 
-    int n = fconcat(mem_stream, start, end);
+    if (data->number_of_players <= SCOREBOARD_TOP)
+        return;
 
-    fclose(mem_stream);
+    position = standings_position(&data->standings, player);
 
-    if (n == -1)
+    if (position > SCOREBOARD_TOP)
     {
-        free(buffer);
-        buffer = NULL;
+        fputws(L"...\n", stream);
+        scoreboard_render_row(stream, &data->board, player, data->curr_round);
     }
 
-    return buffer;
+    fwprintf(stream, L"%S: %dª posição de %d\n", player_name(data, player), position, data->number_of_players);
 }
 
-void fcentered(FILE *stream, wchar_t *s, wchar_t placeholder, int field_width)
-{
-    int i, str_len = wstr_size(s);
-
-    int remaining_length = (field_width - str_len);
+void show_ranking(FILE *stream, game_data *data)
+{ /* posição no ranking geral de cada jogador da partida (nas salas grandes, dos primeiros colocados), se houver ranking */
+    leaderboard *lb = data->leaderboard;
+    player_stats *s;
+    int i, p, shown = data->number_of_players, top[SCOREBOARD_TOP];
 
-    if (remaining_length <= 0)
-        remaining_length = 0;
+    if (lb == NULL)
+        return;
 
-    for (i = 0; i < remaining_length / 2; i++)
-        putwc(placeholder, stream);
+    if (shown > SCOREBOARD_TOP)
+        shown = standings_top(&data->standings, SCOREBOARD_TOP, top);
 
-    for (i = 0; i < str_len; i++)
-        putwc(s[i], stream);
+    fwprintf(stream, L"\nRanking geral (%d jogadores):\n", lb->count);
 
-    for (i = 0; i < remaining_length - remaining_length / 2; i++)
-        putwc(placeholder, stream);
-}
+    for (int k = 0; k < shown; k++)
+    {
+        p = (data->number_of_players > SCOREBOARD_TOP)? top[k]: k;
 
-wchar_t *centered(wchar_t *s, wchar_t placeholder, int field_width)
-{
-    wchar_t *buffer;
-    size_t len;
-    FILE *mem_stream = open_wmemstream(&buffer, &len);
+        if ((i = leaderboard_find(lb, player_name(data, p))) == -1)
+            continue;
 
-    int str_len = wstr_size(s);
+        s = &lb->players[i];
+        fwprintf(stream, L"%5dº  %-*S %u vitória(s) em %u partida(s), %lld pontos, %.2lf s por turno\n",
+                 leaderboard_rank(lb, i), data->name_size, player_name(data, p), s->wins, s->games,
+                 (long long)s->points, s->turns? s->time * 1E-9 / s->turns: 0.);
+    }
+}
 
-    int remaining_length = (field_width - str_len), i;
+static int show_top(leaderboard *lb, int k)
+{ /* os <k> primeiros do ranking geral, com a melhor categoria de cada um */
+    int *top = malloc(k * sizeof(int)), n, best;
+    const category_stats *c;
+    player_stats *s;
 
-    if (remaining_length <= 0)
-        remaining_length = 0;
+    if (top == NULL)
+        return -1;
 
-    for (i = 0; i < remaining_length / 2; i++)
-        putwc(placeholder, mem_stream);
+    n = leaderboard_top(lb, k, top);
 
-    for (i = 0; i < str_len; i++)
-        putwc(s[i], mem_stream);
+    wprintf(L"Ranking geral: %d jogador(es)\n\n", lb->count);
 
-    fflush(mem_stream); /* required to <len> stay up to date */
+    for (int i = 0; i < n; i++)
+    {
+        s = &lb->players[top[i]];
+        best = -1;
 
-    for (i = len; i < field_width; i++)
-        putwc(placeholder, mem_stream);
+        for (int j = 0; j < lb->header.categories; j++)
+        {
+            c = &s->category[j];
 
-    fclose(mem_stream);
+            if (c->rounds > 0 && (best == -1 || c->points * s->category[best].rounds > s->category[best].points * c->rounds))
+                best = j;
+        }
 
-    return buffer;
-}
+        wprintf(L"%5dº  %-20s %5u vitória(s) %5u partida(s) %8lld pontos %6.2lf s/turno",
+                i + 1, s->name, s->wins, s->games, (long long)s->points, s->turns? s->time * 1E-9 / s->turns: 0.);
 
-void frepeat(FILE *stream, wchar_t *r, wchar_t *sep, int n)
-{
+        if (best != -1)
+            wprintf(L"  melhor: %s (%.1lf pontos/rodada, %u de %u)", lb->header.category[best],
+                    s->category[best].points / (double)s->category[best].rounds, s->category[best].hits, s->category[best].rounds);
 
-    for (int i = 0; i < n - 1; i++)
-    {
-        fputws(r, stream);
-        if (sep != NULL) fputws(sep, stream);
+        wprintf(L"\n");
     }
 
-    fputws(r, stream);
+    free(top);
+
+    return 0;
 }
 
-int max_str(wchar_t const * const*S, int n)
-{
+void wait_enter(void)
+{ /* exibe o quadro e aguarda <Enter>, descartando o que for digitado */
+    wchar_t *line;
 
-    int max_len = 0, size;
+    render_present();
 
-    for (int i = 0; i < n; i++)
+    if (get_line(NULL, READER_LINE, NULL, &line) > 0)
     {
-        size = wstr_size(S[i]);
-
-        if (size > max_len)
-            max_len = size;
+        render_echo(line);
+        free(line);
     }
+}
 
-    return max_len;
+void line_breaks(int n) {
+    frepeat(screen, L"\n", NULL, n);
 }
 
-int sum(int *A, int n)
-{
-    double s = 0;
+int victor(game_data *data)
+{ /* maior total; no empate, menos tempo gasto e, depois, o primeiro assento; uma vez por partida */
+    int champ = 0;
 
-    for (int i = 0; i < n; i++)
-        s += A[i];
+    for (int p = 1; p < data->number_of_players; p++)
+        if (data->total[p] > data->total[champ] || (data->total[p] == data->total[champ] && data->time_used[p] < data->time_used[champ]))
+            champ = p;
 
-    return s;
+    return champ;
 }
 
-void *init_array(void *A, unsigned len) {
-    unsigned char *p = A;
-
-    while (len--) {
-        *p++ = 0;
-    }
+game_data new_game(game_config *config)
+{ /* a partida segura uma referência a <config>, solta em <free_game()> */
+    game_data data = {config_retain(config), config->name_size, config->number_of_letters, config->letters, config->rounds,
+                      config->number_of_categories, config->categories, config->min_time, config->time_decrement,
+                      config->answer_size, config->dictionary};
 
-    return A; 
+    return data;
 }
 
-void show_scores(game_data *data)
-{
-    int round = data->curr_round, cat;
-
-    if (round < 0 || round >= data->rounds)
-        return;
+static int init_board(game_data *data)
+{ /* colunas da tabela na ordem em que as categorias serão jogadas */
+    const wchar_t **columns = malloc(data->rounds * sizeof(wchar_t *));
+    int status;
 
-    // wchar_t h_template = fwstring("Jogador  ")
+    if (columns == NULL)
+        return -1;
 
-    // wchar_t *header = fwstring("Categoria ")
+    for (int r = 0; r < data->rounds; r++)
+        columns[r] = data->categories[data->categories_sequence[r]];
 
-    int cat_field_w = max_str(data->categories, data->rounds);
-    size_t len_h;
-    // wchar_t *nome = centered(L"Nome", L' ', cat_field_w);
-    // wchar_t *de = centered(L"de", L' ', cat_field_w);
-    // wchar_t *buffer1, *buffer2;
-    wchar_t *buffer, *header, sep[] = L" | ", placeholder = L' ';
+    status = scoreboard_init(&data->board, data->number_of_players, data->rounds, data->name_size, data->rounds * data->answer_size, data->names, columns);
 
-    FILE *h_stream = open_wmemstream(&header, &len_h);
+    free(columns);
 
-    frepeat(h_stream, L" ", NULL, data->name_size);
+    return status;
+}
 
-    fputws(sep, h_stream);
+static size_t column(size_t *offset, size_t size)
+{ /* reserva <size> bytes no bloco dos jogadores, a partir de uma linha de cache */
+    size_t start = *offset;
 
-    buffer = centered(L"Nome", placeholder, cat_field_w);
+    *offset += (size + 63) & ~(size_t)63;
 
-    frepeat(h_stream, buffer, sep, round + 1);
+    return start;
+}
 
-    fputws(sep, h_stream);
+static int init_players(game_data *data, wchar_t *const *names)
+{ /* colunas de <data> e sequências da partida num só bloco zerado; nomes copiados e truncados */
+    int players = data->number_of_players, humans = players - data->bots;
+    size_t offset = 0, names_at, score_at, total_at, used_at, turn_at, answer_at, order_at, letters_at, categories_at;
+    char *block;
+
+    names_at = column(&offset, (size_t)players * (data->name_size + 1) * sizeof(wchar_t));
+    score_at = column(&offset, (size_t)players * data->rounds * sizeof(int));
+    total_at = column(&offset, players * sizeof(int));
+    used_at = column(&offset, players * sizeof(nsec));
+    turn_at = column(&offset, players * sizeof(nsec));
+    answer_at = column(&offset, players * sizeof(str8 *));
+    order_at = column(&offset, players * sizeof(int));
+    letters_at = column(&offset, data->rounds * sizeof(int));
+    categories_at = column(&offset, data->rounds * sizeof(int));
+
+    if (posix_memalign(&data->players_block, 64, offset) != 0)
+    {
+        data->players_block = NULL;
+        return -1;
+    }
 
-    frepeat(h_stream, L" ", NULL, cat_field_w);
+    block = memset(data->players_block, 0, offset);
 
-    putwc(L'\n', h_stream);
+    data->names = (wchar_t *)(block + names_at);
+    data->score = (int *)(block + score_at);
+    data->total = (int *)(block + total_at);
+    data->time_used = (nsec *)(block + used_at);
+    data->turn_time = (nsec *)(block + turn_at);
+    data->round_answer = (str8 **)(block + answer_at);
+    data->players_sequence = (int *)(block + order_at);
+    data->letters_sequence = (int *)(block + letters_at);
+    data->categories_sequence = (int *)(block + categories_at);
 
-    free(buffer);
+    for (int p = 0; p < players; p++)
+    {
+        if (p < humans)
+            wcsncpy(player_name(data, p), names[p], data->name_size);
+        else
+            swprintf(player_name(data, p), data->name_size + 1, L"Robô %02d", p + 1);
+    }
 
+    return 0;
+}
 
-    // frepeat(h_stream, L" ", NULL, data->name_size);
+/*
+ *  Aloca respostas, escores (por rodada), tempos, ordens e a tabela de
+ *  escores de <data>, cujos <number_of_players>, <bots> e <seed> já devem
+ *  estar definidos, e sorteia, com o gerador da partida semeado por
+ *  <seed>, as letras e categorias de cada rodada. <names> traz os nomes
+ *  dos humanos, que ocupam os primeiros assentos; são copiados, e
+ *  continuam pertencendo a quem chama.
+ *  Retorna 0 em caso de sucesso e -1 caso falte memória.
+ */
 
-    fcentered(h_stream, L"Jogador", placeholder, data->name_size);
+int init_game(game_data *data, wchar_t *const *names)
+{
+    rng_seed(&data->rng, data->seed);
 
-    fputws(sep, h_stream);
+    if (init_players(data, names) == -1)
+        return -1;
 
-    buffer = centered(L"de", placeholder, cat_field_w);
+    draw_sequence(&data->rng, data->letters_sequence, data->rounds, data->number_of_letters);
+    draw_sequence(&data->rng, data->categories_sequence, data->rounds, data->number_of_categories);
+    seat_order(data);
 
-    frepeat(h_stream, buffer, sep, round + 1);
+    if (data->journal != NULL)
+        data->game_id = journal_new_game(data->journal);
 
-    fputws(sep, h_stream);
+    if (init_tally(&data->tally, data->number_of_players, data->answer_size) == -1)
+        return -1;
 
-    free(buffer);
+    if (standings_init(&data->standings, data->number_of_players) == -1)
+        return -1;
 
-    // buffer = centered(L"Total", placeholder, cat_field_w);
+    if (init_board(data) == -1)
+        return -1;
 
-    // fputws(buffer, h_stream);
+    if ((data->no_answer = str8_new(NULL, "", 0)) == NULL)
+        return -1;
 
-    fcentered(h_stream, L"Total", placeholder, cat_field_w);
+    /* uma resposta e um prompt por jogador cabem, em geral, num só bloco */
+    arena_init(&data->round_arena, data->number_of_players * (data->answer_size + 128) * WCHAR_SIZE);
 
-    putwc(L'\n', h_stream);
+    return 0;
+}
 
-    frepeat(h_stream, L" ", NULL, data->name_size);
+void free_game(game_data *data)
+{
+    free(data->players_block);
+    free_tally(&data->tally);
+    standings_free(&data->standings);
+    scoreboard_free(&data->board);
+    arena_free(&data->round_arena);
+    free(data->no_answer);
+    config_release(data->config);
+}
 
-    fputws(sep, h_stream);
+static void usage(char *program)
+{
+    fwprintf(stderr, L"Uso: %s [--config <arquivo>] [--dicionario <arquivo ou diretório>] [--diario <arquivo>] [--ranking <arquivo>] [--semente <n>] [--medidas <arquivo>] [--servidor <porta> [jogadores por sala] [--simultaneo]]\n"
+                     L"       %s [--config <arquivo>] [--dicionario <arquivo ou diretório>] [--diario <arquivo>] [--ranking <arquivo>] --simular <partidas> [jogadores] [--semente <n>] [--roteiro <arquivo>] [--medidas <arquivo>]\n"
+                     L"       %s [--config <arquivo>] [--dicionario <arquivo ou diretório>] --torneio <partidas> [jogadores] [--threads <n>] [--semente <n>] [--roteiro <arquivo>] [--medidas <arquivo>]\n"
+                     L"       %s --ranking <arquivo> --top <n>\n"
+                     L"Robôs (exigem --dicionario; ocupam os últimos assentos; com --simular ou --torneio e dicionário, os demais jogadores também são robôs, salvo com --roteiro): [--robos <n>] [--habilidade <0 a 100>] [--latencia <segundos>]\n",
+             program, program, program, program);
+}
 
-    // FILE *b_stream = open_wmemstream(&buffer, &len_b);
+static void write_stats(const char *path)
+{ /* resumo das medidas por fase, ao fim da partida, da simulação ou do torneio */
+    if (path != NULL && probe_write(path) == -1)
+        fwprintf(stderr, L"\n\tFalha ao gravar as medidas <%s>.\n\terrno (código do último erro) == %d\n", path, errno);
+}
 
-    // wchar_t *s1 = fwstring(L"%12S%S", L"Nome", L"%S");
+int main(int argc, char *argv[])
+{
+    int operation_status, top = 0, tournament = 0, bots = 0, skill = 50, winner, journal_error = 0;
+    nsec turn_start, turn_end;
+    char *config_path = NULL, *dict_path = NULL, *journal_path = NULL, *ranking_path = NULL;
+    game_config *config;
+    int error_line;
+    journal *log = NULL;
+    leaderboard *ranking = NULL;
+    sim_options sim = {0, 2, 0, NULL, 0, {.5, 3.}, pool_cpus()};
+    server_options server = {0, 2, 0, {.5, 3.}, 0, NULL, NULL, NULL, 0};
 
-    wchar_t *cat_name;
+    setlocale(LC_ALL, "");
+    sim.seed = server.seed = rng_mix(time(NULL), getpid()); /* trocada por <--semente> */
 
-    for (cat = 0; cat < round + 1; cat++)
+    for (int i = 1; i < argc; i++)
     {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc)
+            config_path = argv[++i];
+        else if (strcmp(argv[i], "--dicionario") == 0 && i + 1 < argc)
+            dict_path = argv[++i];
+        else if (strcmp(argv[i], "--diario") == 0 && i + 1 < argc)
+            journal_path = argv[++i];
+        else if (strcmp(argv[i], "--ranking") == 0 && i + 1 < argc)
+            ranking_path = argv[++i];
+        else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+            top = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc)
+        {
+            server.port = atoi(argv[++i]);
 
-        cat_name = (wchar_t *) data->categories[data->categories_sequence[cat]];
-
-        // buffer = centered(cat_name, L" ", cat_field_w);
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                server.players_per_room = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc)
+        {
+            sim.games = atoi(argv[++i]);
 
-        // fputws(buffer, h_stream);
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                sim.players = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--robos") == 0 && i + 1 < argc)
+            bots = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--habilidade") == 0 && i + 1 < argc)
+            skill = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--latencia") == 0 && i + 1 < argc)
+            server.bot.latency = atof(argv[++i]);
+        else if (strcmp(argv[i], "--torneio") == 0 && i + 1 < argc)
+        {
+            tournament = 1;
+            sim.games = atoi(argv[++i]);
 
-        // free(buffer);
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                sim.players = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            sim.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+            sim.seed = server.seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--roteiro") == 0 && i + 1 < argc)
+            sim.script = argv[++i];
+        else if (strcmp(argv[i], "--medidas") == 0 && i + 1 < argc)
+            server.stats_path = argv[++i];
+        else if (strcmp(argv[i], "--simultaneo") == 0)
+            server.simultaneous = 1;
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
 
-        fcentered(h_stream, cat_name, placeholder, cat_field_w);
+    if ((server.port != 0 || sim.games != 0 || top != 0 || config_path != NULL) && MB_CUR_MAX == 1)
+        setlocale(LC_CTYPE, "C.UTF-8"); /* clientes, roteiros, pacotes e nomes do ranking em UTF-8 */
 
-        fputws(sep, h_stream);
+    if (server.simultaneous && server.port == 0)
+    { /* num só terminal, os jogadores dividem o teclado: só o servidor os atende ao mesmo tempo */
+        usage(argv[0]);
+        return EXIT_FAILURE;
     }
 
-    buffer = centered(L"Parcial", placeholder, cat_field_w);
-
-    fputws(buffer, h_stream);
+    if (tournament && (journal_path != NULL || ranking_path != NULL || server.port != 0))
+    { /* as partidas do torneio não compartilham nada que se altere */
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
 
-    fputws(L"\n", h_stream);
+    if (bots < 0 || bots >= MAX_PLAYERS || skill < 0 || skill > 100 || server.bot.latency < 0 || (bots > 0 && top != 0) || (sim.games != 0 && bots >= sim.players))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
 
-    free(buffer);
+    server.bots = bots;
+    server.bot.skill = skill / 100.;
+    sim.bots = bots;
+    sim.bot = server.bot;
+    server.config_path = config_path;
+    server.dict_path = dict_path;
+    probe_enabled = (server.stats_path != NULL);
 
-    frepeat(h_stream, L"*", NULL, (round + 2)*wstr_size(sep) + data->name_size + (round + 2)*cat_field_w);
+    if ((config = config_load(config_path, dict_path, &error_line)) == NULL)
+    {
+        if (error_line > 0)
+            fwprintf(stderr, L"\n\tLinha %d inválida no pacote <%s>.\n", error_line, config_path);
+        else if (error_line == 0)
+            fwprintf(stderr, L"\n\tFalha ao carregar o pacote <%s>.\n\terrno (código do último erro) == %d\n", (config_path != NULL)? config_path: "embutido", errno);
+        else
+            fwprintf(stderr, L"\n\tFalha ao carregar o dicionário de <%s>.\n\terrno (código do último erro) == %d\n", dict_path, errno);
+        return EXIT_FAILURE;
+    }
 
-    fputws(L"\n", h_stream);
+    if (bots > 0 && config->bots == NULL)
+    {
+        fwprintf(stderr, L"\n\tOs robôs tiram as palavras do dicionário: use <--dicionario>.\n");
+        return EXIT_FAILURE;
+    }
 
-    wchar_t *name;
-    int player, score;
+    if (journal_path != NULL && (log = journal_open(journal_path)) == NULL)
+    {
+        fwprintf(stderr, L"\n\tFalha ao abrir o diário <%s>.\n\terrno (código do último erro) == %d\n", journal_path, errno);
+        return EXIT_FAILURE;
+    }
 
-    for (int turn = 0; turn < data->number_of_players; turn++)
+    if (ranking_path != NULL && (ranking = leaderboard_open(ranking_path)) == NULL)
     {
-        player = data->players_sequence[turn];
+        if (errno == EWOULDBLOCK)
+            fwprintf(stderr, L"\n\tO ranking <%s> está em uso por outro processo.\n", ranking_path);
+        else
+            fwprintf(stderr, L"\n\tFalha ao abrir o ranking <%s>.\n\terrno (código do último erro) == %d\n", ranking_path, errno);
+        return EXIT_FAILURE;
+    }
 
-        for (int i = 0; i < round + 3; i++)
+    if (top != 0)
+    {
+        if (ranking == NULL || top < 0)
         {
-            if (i == 0)
-            {
-                name = data->player_name[player];
-                fcentered(h_stream, name, placeholder, data->name_size);
-            }
-            else if (i == round + 2)
-            {
-                score = sum(data->score[player], data->rounds);
-                buffer = fwstring(L"%d", score);
-                fcentered(h_stream, buffer, placeholder, cat_field_w);
-                free(buffer);
-                break;
-            }
-            else
-            {
-                score = data->score[player][data->categories_sequence[i - 1]];
-                buffer = fwstring(L"%d", score);
-                fcentered(h_stream, buffer, placeholder, cat_field_w);
-                free(buffer);
-            }
-
-            fputws(sep, h_stream);
-            
+            usage(argv[0]);
+            return EXIT_FAILURE;
         }
-        putwc(L'\n', h_stream);
-    }
-
-    fclose(h_stream);
 
-    fputws(header, stdout);
+        operation_status = show_top(ranking, top);
+        leaderboard_close(ranking);
+        config_release(config);
 
-    free(header);
-}
-
-void line_breaks(int n) {
-    frepeat(stdout, L"\n", NULL, n);
-}
+        return operation_status == 0? EXIT_SUCCESS: EXIT_FAILURE;
+    }
 
-int victor(game_data *data) {
-    int **score = data->score, rounds = data->rounds;
+    if (server.port != 0)
+        return server_run(&server, config, log, ranking) == 0? EXIT_SUCCESS: EXIT_FAILURE;
 
-    int champ = 0, p, champ_score = sum(score[0], rounds), p_score;
+    if (tournament)
+    {
+        operation_status = sim_tournament(&sim, config);
+        config_release(config);
+        write_stats(server.stats_path);
 
-    int *timing = data->time_used;
-
-    for (p = 1; p < data->number_of_players; p++) {
-        
-        p_score = sum(score[p], rounds);
-        
-        if (p_score > champ_score) {
-            champ_score = p_score;
-            champ = p;
-        } else if (p_score == champ_score) {
-            if (timing[p] < timing[champ]) champ = p;
-        }
+        if (operation_status == -1)
+            fwprintf(stderr, L"\n\tFalha no torneio.\n\terrno (código do último erro) == %d\n", errno);
 
+        return operation_status == 0? EXIT_SUCCESS: EXIT_FAILURE;
     }
 
-    return champ;
+    if (sim.games != 0)
+    {
+        operation_status = sim_run(&sim, config, log, ranking);
+        config_release(config);
+        write_stats(server.stats_path);
 
-}
+        if (journal_close(log) == -1 && operation_status == 0)
+            fwprintf(stderr, L"\n\tFalha ao gravar o diário <%s>.\n\terrno (código do último erro) == %d\n", journal_path, errno);
 
-int same_str(wchar_t *a, wchar_t *b) {
-    int l = wstr_size(a);
-    if (l != wstr_size(b)) return 0;
+        if (leaderboard_close(ranking) == -1 && operation_status == 0)
+            fwprintf(stderr, L"\n\tFalha ao gravar o ranking <%s>.\n\terrno (código do último erro) == %d\n", ranking_path, errno);
 
-    for (int i = 0; i < l; i++) {
-        if (towupper(a[i]) != towupper(b[i])) return 0;
-    }
+        if (operation_status == -1)
+            fwprintf(stderr, L"\n\tFalha na simulação.\n\terrno (código do último erro) == %d\n", errno);
 
-    return 1;
-}
+        return operation_status == 0? EXIT_SUCCESS: EXIT_FAILURE;
+    }
 
-int main(int argc, char *argv[])
-{
-    const int name_size = 12;
-    const int number_of_letters = 23;
-    const wchar_t *const letters = L"ABCDEFGHIJLMNOPQRSTUVXZ";
-    const int rounds = 5;
-    const wchar_t *const categories[] = {L"Pessoas", L"Cidades", L"Animais", L"Comidas", L"Profissões"};
-    const double min_time = 8;
-    const double time_decrement = 2;
+    game_data data = new_game(config);
 
-    int operation_status;
+    config_release(config); /* fica com a partida */
+    data.journal = log;
+    data.leaderboard = ranking;
+    data.bots = bots;
+    data.bot_profile = &server.bot;
+    data.seed = server.seed;
 
-    setlocale(LC_ALL, "");
-    srand(time(NULL));
+    reader_init(&input, fileno(stdin));
 
-    game_data data = {name_size, number_of_letters, letters, rounds, categories, min_time, time_decrement};
+    if (render_init() == -1)
+    {
+        fwprintf(stderr, L"\n\tFalha ao iniciar a tela.\n\terrno (código do último erro) == %d\n", errno);
+        return EXIT_FAILURE;
+    }
 
     clear();
     // wprintf(L"ASADASD %C\n", towupper(L'á'));
 
-    fputws(L"Insira o número de jogadores (entre 2 e 10): ", stdout);
-    fflush(stdout);
+    if (bots == 0)
+        fwprintf(screen, L"Insira o número de jogadores (entre 2 e %d): ", MAX_PLAYERS);
+    else
+        fwprintf(screen, L"Insira o número de jogadores humanos (entre %d e %d), além de %d robô(s): ", (bots > 1)? 1: 2 - bots, MAX_PLAYERS - bots, bots);
+    render_present();
+
+    data.number_of_players = (int)get_int((bots > 1)? 1: 2 - bots, MAX_PLAYERS - bots, NULL);
 
-    data.number_of_players = (int)get_int(2, 10, NULL);
+    if (data.number_of_players != -1)
+        data.number_of_players += bots;
+    else
+    {
+        fwprintf(screen, L"\n\tFalha ao obter número de jogadores.\n\terrno (código do último erro) == %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
 
     clear();
 
-    wprintf(L"Número de jogadores: %d\n", data.number_of_players);
+    fwprintf(screen, L"Número de jogadores: %d\nSemente da partida: %llu\n", data.number_of_players, (unsigned long long)data.seed);
 
 
     newline();
 
-    operation_status = get_names(&data);
+    wchar_t **names = calloc(data.number_of_players, sizeof(wchar_t *));
+
+    operation_status = (names != NULL)? get_names(&data, names): -1;
 
     newline();
 
     if (operation_status == -1)
     {
-        wprintf(L"\n\tFalha ao obter nomes dos jogadores.\n\terrno (código do último erro) == %d\n", errno);
+        fwprintf(screen, L"\n\tFalha ao obter nomes dos jogadores.\n\terrno (código do último erro) == %d\n", errno);
         exit(EXIT_FAILURE);
     }
 
+    operation_status = init_game(&data, names);
 
-    data.letters_sequence = index_permutation(data.number_of_letters);
-    data.categories_sequence = index_permutation(data.rounds);
-
-    data.round_answer = malloc(sizeof(wchar_t *) * data.number_of_players);
+    for (int p = 0; p < data.number_of_players; p++)
+        free(names[p]);
 
-    data.score = calloc(data.number_of_players, sizeof(int *));
+    free(names);
 
-    data.time_used = calloc(data.number_of_players, sizeof(double));
-
-    int answer_ocurrences;
+    if (operation_status == -1)
+    {
+        fwprintf(screen, L"\n\tFalha ao iniciar o jogo.\n\terrno (código do último erro) == %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
 
     for (data.curr_round = 0; data.curr_round < data.rounds; data.curr_round++)
     {
 
-        wprintf(L"\nPressione <Enter> para começar a %dª rodada: ", data.curr_round + 1);
-        getwchar();
+        fwprintf(screen, L"\nPressione <Enter> para começar a %dª rodada: ", data.curr_round + 1);
+        wait_enter();
 
         clear();
 
-        wprintf(L"Rodada %02d\n", data.curr_round + 1);
+        fwprintf(screen, L"Rodada %02d\n", data.curr_round + 1);
 
         wchar_t curr_letter = data.letters[data.letters_sequence[data.curr_round]];
         const wchar_t *curr_cat = data.categories[data.categories_sequence[data.curr_round]];
 
-        wprintf(L"\nLetra da rodada: %C\n", curr_letter);
+        fwprintf(screen, L"\nLetra da rodada: %C\n", curr_letter);
 
-        wprintf(L"\nCategoria da rodada: %S\n", curr_cat);
+        fwprintf(screen, L"\nCategoria da rodada: %S\n", curr_cat);
 
         newline();
 
-        data.players_sequence = index_permutation(data.number_of_players);
+        draw_turn_order(&data);
 
         putws(L"Ordem da rodada:");
-        show_players(&data);
-
-        fputws(L"\nPressione <Enter> para começar: ", stdout);
-        getwchar();
+        show_players(screen, &data);
 
-        wprintf(L"sdfjisfjsidfj\n\n");
+        fputws(L"\nPressione <Enter> para começar: ", screen);
+        wait_enter();
 
         for (data.curr_turn = 0; data.curr_turn < data.number_of_players; data.curr_turn++)
         {
 
-            if (data.curr_round == 0) {
-                data.score[data.players_sequence[data.curr_turn]] = calloc(data.rounds, sizeof(int));
-                init_array(data.score[data.players_sequence[data.curr_turn]], data.rounds);
-                data.time_used[data.players_sequence[data.curr_turn]] = 0;
-            } 
-
             clear();
-            set_time(&data.curr_time_left, player_total_time(&data));
+            turn_start = timer_now();
+            data.curr_time_left = turn_start + seconds_to_ns(player_total_time(&data));
 
             data.round_answer[data.players_sequence[data.curr_turn]] = get_answer(&data);
-            wprintf(L"shit\n");
 
 
             if (data.round_answer[data.players_sequence[data.curr_turn]] == NULL)
@@ -1084,35 +1184,35 @@ int main(int argc, char *argv[])
 
                 if (time_left(data.curr_time_left) == 0.0)
                 {
-                    data.round_answer[data.players_sequence[data.curr_turn]] = fwstring(L"%C", L'\0');
+                    data.round_answer[data.players_sequence[data.curr_turn]] = data.no_answer;
                 }
                 else
                 {
-                    wprintf(L"\n\tFalha ao obter resposta de %S.\n\terrno (código do último erro) == %d\n", data.player_name[data.players_sequence[data.curr_turn]], errno);
+                    fwprintf(screen, L"\n\tFalha ao obter resposta de %S.\n\terrno (código do último erro) == %d\n", player_name(&data, data.players_sequence[data.curr_turn]), errno);
                     exit(EXIT_FAILURE);
                 }
             }
 
-            data.time_used[data.players_sequence[data.curr_turn]] += player_total_time(&data) - time_left(data.curr_time_left);
+            turn_end = timer_now();
+            charge_turn(&data, data.players_sequence[data.curr_turn], ((turn_end < data.curr_time_left)? turn_end: data.curr_time_left) - turn_start);
 
         }
 
-        for (int p = 0; p < data.number_of_players; p++) {
-
-            answer_ocurrences = 1;
-            
-            for (int i = 0; i < data.number_of_players; i++) {
-                if (i != p && same_str(data.round_answer[data.players_sequence[p]], data.round_answer[data.players_sequence[i]])) {
-                    answer_ocurrences++;
-                }
-            }
-
-            data.score[data.players_sequence[p]][data.categories_sequence[data.curr_round]] = round(wstr_size(data.round_answer[data.players_sequence[p]])/ (double) answer_ocurrences);
+        if (score_round(&data) == -1)
+        {
+            fwprintf(screen, L"\n\tFalha ao pontuar a rodada.\n\terrno (código do último erro) == %d\n", errno);
+            exit(EXIT_FAILURE);
         }
 
+        /* só acumula: grava com o buffer cheio ou em <journal_close()>; o aviso vem depois da tabela, que limpa a tela */
+        if (data.journal != NULL && journal_round(data.journal, &data) == -1)
+            journal_error = errno? errno: EIO;
+
 
         clear();
-        show_answers(&data);
+        show_answers(screen, &data);
+
+        arena_reset(&data.round_arena); /* respostas e prompts da rodada */
 
         line_breaks(2);
 
@@ -1120,15 +1220,22 @@ int main(int argc, char *argv[])
 
         newline();
 
-        show_scores(&data);
+        show_scores(screen, &data);
+
+        for (int p = 0; p < data.number_of_players - data.bots; p++)
+            show_standing(screen, &data, p);
 
-        free(data.players_sequence);
+        if (journal_error != 0)
+        {
+            fwprintf(screen, L"\n\tFalha ao gravar a rodada no diário <%s>.\n\terrno (código do último erro) == %d\n", journal_path, journal_error);
+            journal_error = 0;
+        }
     }
 
     line_breaks(2);
 
-    fputws(L"\nPressione <Enter> para continuar: ", stdout);
-    getwchar();
+    fputws(L"\nPressione <Enter> para continuar: ", screen);
+    wait_enter();
 
     clear();
 
@@ -1136,21 +1243,28 @@ int main(int argc, char *argv[])
 
     data.curr_round--;
 
-    data.players_sequence = ascending_sequence(data.number_of_players);
+    seat_order(&data);
+
+    show_scores(screen, &data);
 
-    show_scores(&data);
+    for (int p = 0; p < data.number_of_players - data.bots; p++)
+        show_standing(screen, &data, p);
 
     line_breaks(2);
 
-    wprintf(L"Vencedor: %S.\n", data.player_name[victor(&data)]);
+    winner = victor(&data);
+    fwprintf(screen, L"Vencedor: %S.\n", player_name(&data, winner));
 
-    for (int p = 0; p < data.number_of_players; p++) free(data.score[p]);
+    if (data.leaderboard != NULL && leaderboard_game(data.leaderboard, &data, winner) == 0)
+        show_ranking(screen, &data);
 
-    free(data.score);
-    free(data.letters_sequence);
-    free(data.categories_sequence);
-    free(data.round_answer);
-    free(data.time_used);
+    free_game(&data);
+
+    if (journal_close(log) == -1)
+        fwprintf(screen, L"\n\tFalha ao gravar o diário <%s>.\n\terrno (código do último erro) == %d\n", journal_path, errno);
+
+    leaderboard_close(ranking);
+    write_stats(server.stats_path);
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
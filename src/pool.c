@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <pool.h>
+
+#define CACHE_LINE 64
+
+typedef struct {
+    uint64_t range; /* início nos 32 bits altos, fim nos baixos */
+} __attribute__((aligned(CACHE_LINE))) slice;
+
+typedef struct {
+    slice *slices;
+    int workers;
+    pool_task task;
+    void *context;
+} pool;
+
+typedef struct {
+    pool *p;
+    int id;
+} worker_arg;
+
+static uint64_t pack(uint32_t begin, uint32_t end)
+{
+    return (uint64_t)begin << 32 | end;
+}
+
+static int take(slice *s, uint32_t *index)
+{ /* próximo índice da própria fatia */
+    uint64_t range = __atomic_load_n(&s->range, __ATOMIC_ACQUIRE);
+    uint32_t begin, end;
+
+    do
+    {
+        begin = range >> 32;
+        end = (uint32_t)range;
+
+        if (begin >= end)
+            return 0;
+    } while (!__atomic_compare_exchange_n(&s->range, &range, pack(begin + 1, end), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    *index = begin;
+
+    return 1;
+}
+
+static int steal(slice *victim, slice *mine)
+{ /* metade final da fatia de <victim>, que passa a ser a de <mine>, já vazia */
+    uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+    uint32_t begin, end, middle;
+
+    do
+    {
+        begin = range >> 32;
+        end = (uint32_t)range;
+
+        if (begin >= end)
+            return 0;
+
+        middle = end - (end - begin + 1) / 2;
+    } while (!__atomic_compare_exchange_n(&victim->range, &range, pack(begin, middle), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    /* índices nunca voltam a uma fatia: sem ABA para quem ainda a observa */
+    __atomic_store_n(&mine->range, pack(middle, end), __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+static void *work(void *arg)
+{
+    pool *p = ((worker_arg *)arg)->p;
+    int id = ((worker_arg *)arg)->id, v;
+    slice *mine = &p->slices[id];
+    uint32_t index;
+
+    for (;;)
+    {
+        while (take(mine, &index))
+            p->task(index, id, p->context);
+
+        for (v = 1; v < p->workers; v++)
+            if (steal(&p->slices[(id + v) % p->workers], mine))
+                break;
+
+        if (v == p->workers) /* nada mais a roubar: o que falta já está em execução */
+            return NULL;
+    }
+}
+
+int pool_cpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (n > 0)? n: 1;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Executa <task(i, worker, context)> para todo i em [0, n), com até
+ *  <workers> threads, e retorna quando todas as tarefas terminarem.
+ *
+ *  - RETORNO:
+ *
+ *  0 em caso de sucesso e -1 em caso de erro (ver <errno>), antes de
+ *  qualquer tarefa ser executada.
+ */
+
+int pool_run(int workers, long n, pool_task task, void *context)
+{
+    pthread_t *threads;
+    worker_arg *args;
+    pool p = {NULL, workers, task, context};
+    int started;
+
+    if (workers < 1 || n < 0 || n > UINT32_MAX)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (workers > n)
+        p.workers = workers = (n > 0)? n: 1;
+
+    if (posix_memalign((void **)&p.slices, CACHE_LINE, workers * sizeof(slice)) != 0)
+        p.slices = NULL;
+
+    threads = malloc(workers * sizeof(pthread_t));
+    args = malloc(workers * sizeof(worker_arg));
+
+    if (p.slices == NULL || threads == NULL || args == NULL)
+    {
+        free(p.slices);
+        free(threads);
+        free(args);
+        return -1;
+    }
+
+    for (int w = 0; w < workers; w++)
+    {
+        p.slices[w].range = pack(n * w / workers, n * (w + 1) / workers);
+        args[w].p = &p;
+        args[w].id = w;
+    }
+
+    for (started = 1; started < workers; started++) /* se faltarem threads, as fatias sem dono são roubadas */
+        if (pthread_create(&threads[started], NULL, work, &args[started]) != 0)
+            break;
+
+    work(&args[0]);
+
+    for (int w = 1; w < started; w++)
+        pthread_join(threads[w], NULL);
+
+    free(p.slices);
+    free(threads);
+    free(args);
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <probe.h>
+
+int probe_enabled = 0;
+
+static probe_histogram phase[PROBES];
+
+static const wchar_t *const phase_name[PROBES] = {L"prompt", L"espera", L"leitura", L"aparo", L"tela", L"pontuação", L"tabela"};
+
+static int bucket_of(uint64_t v)
+{ /* valores pequenos, exatos; os demais, pelo expoente e pelos bits seguintes */
+    int e;
+
+    if (v < (1u << PROBE_SUB_BITS))
+        return v;
+
+    e = 63 - __builtin_clzll(v);
+
+    return ((e - PROBE_SUB_BITS + 1) << PROBE_SUB_BITS) + ((v >> (e - PROBE_SUB_BITS)) & ((1u << PROBE_SUB_BITS) - 1));
+}
+
+static uint64_t bucket_value(int b)
+{ /* meio da faixa <b> */
+    int e = (b >> PROBE_SUB_BITS) + PROBE_SUB_BITS - 1;
+    uint64_t sub = b & ((1u << PROBE_SUB_BITS) - 1);
+
+    if (b < (1 << PROBE_SUB_BITS))
+        return b;
+
+    return (((1ull << PROBE_SUB_BITS) + sub) << (e - PROBE_SUB_BITS)) + (1ull << (e - PROBE_SUB_BITS)) / 2;
+}
+
+void probe_record(int p, nsec elapsed)
+{
+    probe_histogram *h = &phase[p];
+    uint64_t v = (elapsed > 0)? elapsed: 0, max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+
+    __atomic_fetch_add(&h->bucket[bucket_of(v)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, v, __ATOMIC_RELAXED);
+
+    while (v > max && !__atomic_compare_exchange_n(&h->max, &max, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static uint64_t percentile(const probe_histogram *h, uint64_t count, double q)
+{ /* menor faixa que acumula a fração <q> das amostras */
+    uint64_t wanted = q * count + .5, seen = 0, max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+
+    if (wanted == 0)
+        wanted = 1;
+
+    for (int b = 0; b < PROBE_BUCKETS; b++)
+        if ((seen += __atomic_load_n(&h->bucket[b], __ATOMIC_RELAXED)) >= wanted)
+            return (bucket_value(b) < max)? bucket_value(b): max; /* o meio da última faixa pode passar do máximo */
+
+    return max;
+}
+
+void probe_report(FILE *stream)
+{ /* em microssegundos; lido sem parar quem registra, então aproximado enquanto há registros */
+    const probe_histogram *h;
+    uint64_t count;
+
+    fwprintf(stream, L"Fase          amostras          p50          p99         máx.        média  (µs)\n");
+
+    for (int p = 0; p < PROBES; p++)
+    {
+        h = &phase[p];
+
+        if ((count = __atomic_load_n(&h->count, __ATOMIC_RELAXED)) == 0)
+        {
+            fwprintf(stream, L"  %-10S %10d\n", phase_name[p], 0);
+            continue;
+        }
+
+        fwprintf(stream, L"  %-10S %10llu %12.1lf %12.1lf %12.1lf %12.1lf\n", phase_name[p], (unsigned long long)count,
+                 percentile(h, count, .5) * 1E-3, percentile(h, count, .99) * 1E-3,
+                 __atomic_load_n(&h->max, __ATOMIC_RELAXED) * 1E-3,
+                 (double)__atomic_load_n(&h->sum, __ATOMIC_RELAXED) / count * 1E-3);
+    }
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Grava o resumo de <probe_report()> em <path>, por meio de um arquivo
+ *  temporário renomeado sobre ele: quem lê vê sempre um resumo inteiro.
+ *
+ *  - RETORNO:
+ *
+ *  0 em caso de sucesso e -1 em caso de erro (ver <errno>).
+ */
+
+int probe_write(const char *path)
+{
+    size_t n = strlen(path);
+    char *temp = malloc(n + 5);
+    FILE *f;
+    int status = -1;
+
+    if (temp == NULL)
+        return -1;
+
+    memcpy(temp, path, n);
+    memcpy(temp + n, ".tmp", 5);
+
+    if ((f = fopen(temp, "w")) != NULL)
+    {
+        probe_report(f);
+
+        if (fclose(f) == 0 && rename(temp, path) == 0)
+            status = 0;
+        else
+            remove(temp);
+    }
+
+    free(temp);
+
+    return status;
+}
@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <reader.h>
+
+void reader_init(line_reader *r, int fd)
+{
+    r->fd = fd;
+    r->head = r->tail = 0;
+    r->len = 0;
+    r->chars = 0;
+    r->overflow = 0;
+    r->complete = 0;
+    r->eof = 0;
+    r->line[0] = '\0';
+}
+
+size_t reader_push(line_reader *r, const char *bytes, size_t n)
+{ /* devolve ao anel bytes já lidos do descritor por outro meio; retorna quantos couberam */
+    size_t space = READER_RING - (r->tail - r->head);
+
+    if (n > space)
+        n = space;
+
+    for (size_t i = 0; i < n; i++)
+        r->ring[r->tail++ % READER_RING] = bytes[i];
+
+    return n;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Lê de uma só vez o que couber no espaço livre do anel.
+ *
+ *  - RETORNO:
+ *
+ *  o número de bytes lidos; 0 no fim da entrada; -1 em caso de erro (ver
+ *  <errno>), inclusive EAGAIN se o anel estiver cheio ou nada houver a ler.
+ */
+
+ssize_t reader_fill(line_reader *r)
+{
+    struct iovec part[2];
+    size_t start = r->tail % READER_RING, space = READER_RING - (r->tail - r->head);
+    ssize_t n;
+    int parts = 1;
+
+    if (space == 0)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    /* o espaço livre pode dar a volta no anel */
+    part[0].iov_base = r->ring + start;
+    part[0].iov_len = (start + space <= READER_RING)? space: READER_RING - start;
+
+    if (part[0].iov_len < space)
+    {
+        part[1].iov_base = r->ring;
+        part[1].iov_len = space - part[0].iov_len;
+        parts = 2;
+    }
+
+    if ((n = readv(r->fd, part, parts)) > 0)
+        r->tail += n;
+    else if (n == 0)
+        r->eof = 1;
+
+    return n;
+}
+
+static void keep(line_reader *r, const unsigned char *bytes, size_t n, int limit)
+{ /* guarda o início de <bytes> que couber na linha; o resto a transborda */
+    for (size_t i = 0; i < n; i++)
+    {
+        if (bytes[i] == '\r')
+            continue;
+
+        if ((bytes[i] & 0xC0) != 0x80 && r->chars++ == limit) /* início de caractere */
+            r->overflow = 1;
+
+        if (r->len == READER_LINE - 1)
+            r->overflow = 1;
+
+        if (r->overflow)
+            return;
+
+        r->line[r->len++] = bytes[i];
+    }
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Separa a próxima linha dos bytes pendentes, guardando em <line> no
+ *  máximo <limit> caracteres; o '\r' de fins de linha "\r\n" é ignorado.
+ *  Os bytes de uma linha incompleta são consumidos mesmo assim, de modo que
+ *  o anel nunca fica cheio à espera de um '\n'.
+ *
+ *  - RETORNO:
+ *
+ *  1 se uma linha completa (ou a última, sem '\n', no fim da entrada) está
+ *  em <line>, com <overflow> indicando se foi truncada; 0 se faltam dados.
+ */
+
+int reader_next(line_reader *r, int limit)
+{
+    const unsigned char *segment, *newline;
+    size_t start, n;
+
+    if (r->complete)
+    { /* a linha anterior já foi entregue */
+        r->len = 0;
+        r->chars = 0;
+        r->overflow = 0;
+        r->complete = 0;
+    }
+
+    while (r->head != r->tail)
+    {
+        start = r->head % READER_RING;
+        n = r->tail - r->head;
+
+        if (start + n > READER_RING)
+            n = READER_RING - start; /* até o fim do anel; o resto na próxima volta */
+
+        segment = r->ring + start;
+        newline = memchr(segment, '\n', n);
+
+        if (newline != NULL)
+            n = newline - segment;
+
+        if (!r->overflow)
+            keep(r, segment, n, limit);
+
+        r->head += n;
+
+        if (newline != NULL)
+        {
+            r->head++;
+            r->complete = 1;
+            break;
+        }
+    }
+
+    if (!r->complete && r->eof && (r->len > 0 || r->overflow))
+        r->complete = 1;
+
+    if (r->complete)
+        r->line[r->len] = '\0';
+
+    return r->complete;
+}
+
+/*
+ *  Converte a linha completa para texto largo, conforme a localidade, em
+ *  <dst>; devolve o número de caracteres, ou -1 se houver sequência
+ *  inválida (EILSEQ).
+ */
+
+int reader_decode(const line_reader *r, wchar_t dst[READER_LINE])
+{ /* cada byte gera no máximo um caractere */
+    size_t n = mbstowcs(dst, r->line, READER_LINE);
+
+    return (n == (size_t)-1)? -1: (int)n;
+}
@@ -0,0 +1,435 @@
+#define _GNU_SOURCE /* wcwidth() */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <wchar.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <render.h>
+#include <probe.h>
+
+#define WIDE_TAIL L'\0'          /* segunda célula de um caractere de largura 2 */
+#define TEXT_RESET_SIZE (1 << 16) /* caracteres acumulados em <screen> antes de recriá-lo */
+
+FILE *screen = NULL;
+
+typedef struct {
+    wchar_t *cell;
+    int row;
+    int col;
+} frame;
+
+static struct {
+    int tty;
+    int echo; /* o terminal ecoa o que é digitado */
+    int rows;
+    int cols;
+
+    frame front; /* o que está na tela */
+    frame back;  /* o que deveria estar */
+
+    int line_row; /* início, em <back>, da linha editada por <render_line()>; -1 sem edição */
+    int line_col;
+
+    wchar_t *text; /* buffer de <screen> */
+    size_t text_len;
+    size_t consumed;
+
+    char *out;
+    size_t out_len;
+    size_t out_cap;
+} term;
+
+static int out_reserve(size_t n)
+{
+    char *grown;
+    size_t cap = term.out_cap? term.out_cap: 4096;
+
+    if (term.out_len + n <= term.out_cap)
+        return 0;
+
+    while (cap < term.out_len + n)
+        cap *= 2;
+
+    grown = realloc(term.out, cap);
+
+    if (grown == NULL)
+        return -1;
+
+    term.out = grown;
+    term.out_cap = cap;
+
+    return 0;
+}
+
+static void out_bytes(const char *bytes, size_t n)
+{
+    if (out_reserve(n) == 0)
+    {
+        memcpy(term.out + term.out_len, bytes, n);
+        term.out_len += n;
+    }
+}
+
+static void out_char(wchar_t c)
+{
+    mbstate_t state;
+    size_t n;
+
+    if (out_reserve(MB_LEN_MAX) == -1)
+        return;
+
+    memset(&state, 0, sizeof(state));
+    n = wcrtomb(term.out + term.out_len, c, &state);
+
+    if (n == (size_t)-1)
+        term.out[term.out_len++] = '?';
+    else
+        term.out_len += n;
+}
+
+static void out_move(int row, int col)
+{
+    char sequence[32];
+    int n = snprintf(sequence, sizeof(sequence), "\x1b[%d;%dH", row + 1, col + 1);
+
+    out_bytes(sequence, n);
+}
+
+static void out_write(void)
+{
+    size_t sent = 0;
+    ssize_t n;
+
+    while (sent < term.out_len)
+    {
+        n = write(STDOUT_FILENO, term.out + sent, term.out_len - sent);
+
+        if (n <= 0)
+            break;
+
+        sent += n;
+    }
+
+    term.out_len = 0;
+}
+
+static void frame_blank(frame *f)
+{
+    wmemset(f->cell, L' ', term.rows * term.cols);
+    f->row = f->col = 0;
+}
+
+static void frame_newline(frame *f)
+{
+    f->col = 0;
+
+    if (++f->row < term.rows)
+        return;
+
+    /* passou da última linha: rola o quadro, como o terminal faria */
+    wmemmove(f->cell, f->cell + term.cols, (term.rows - 1) * term.cols);
+    wmemset(f->cell + (term.rows - 1) * term.cols, L' ', term.cols);
+    f->row = term.rows - 1;
+
+    if (f == &term.back && term.line_row != -1 && --term.line_row < 0)
+        term.line_row = term.line_col = 0; /* a linha editada já não cabe na tela */
+}
+
+static void frame_put(frame *f, wchar_t c)
+{
+    int width;
+
+    switch (c)
+    {
+    case L'\n':
+        frame_newline(f);
+        return;
+    case L'\r':
+        f->col = 0;
+        return;
+    case L'\t':
+        do
+            frame_put(f, L' ');
+        while (f->col % 8 != 0 && f->col < term.cols);
+        return;
+    }
+
+    if ((width = wcwidth(c)) <= 0)
+        return;
+
+    if (f->col + width > term.cols)
+        frame_newline(f);
+
+    f->cell[f->row * term.cols + f->col] = c;
+
+    if (width == 2)
+        f->cell[f->row * term.cols + f->col + 1] = WIDE_TAIL;
+
+    f->col += width;
+}
+
+static int terminal_size(int *rows, int *cols)
+{
+    struct winsize size;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == -1 || size.ws_row == 0 || size.ws_col == 0)
+        return -1;
+
+    *rows = size.ws_row;
+    *cols = size.ws_col;
+
+    return 0;
+}
+
+static int resize(int rows, int cols)
+{
+    wchar_t *front = malloc(rows * cols * sizeof(wchar_t));
+    wchar_t *back = malloc(rows * cols * sizeof(wchar_t));
+
+    if (front == NULL || back == NULL)
+    {
+        free(front);
+        free(back);
+        return -1;
+    }
+
+    free(term.front.cell);
+    free(term.back.cell);
+
+    term.front.cell = front;
+    term.back.cell = back;
+    term.rows = rows;
+    term.cols = cols;
+
+    frame_blank(&term.front);
+    frame_blank(&term.back);
+    term.line_row = -1;
+
+    out_bytes("\x1b[H\x1b[2J", 7); /* a única limpeza completa: sincroniza <front> */
+
+    return 0;
+}
+
+static int open_screen(void)
+{
+    screen = open_wmemstream(&term.text, &term.text_len);
+    term.consumed = 0;
+
+    return (screen == NULL)? -1: 0;
+}
+
+int render_init(void)
+{
+    int rows, cols;
+
+    term.tty = isatty(STDOUT_FILENO) && terminal_size(&rows, &cols) == 0;
+    term.echo = term.tty && isatty(STDIN_FILENO);
+    term.line_row = -1;
+
+    if (open_screen() == -1)
+        return -1;
+
+    if (term.tty && resize(rows, cols) == -1)
+        return -1;
+
+    atexit(render_end);
+
+    return 0;
+}
+
+static void clear_screen(void)
+{
+    int rows, cols;
+
+    if (screen == NULL)
+        return;
+
+    fflush(screen);
+    term.consumed = term.text_len; /* texto ainda não exibido é descartado */
+
+    if (term.consumed > TEXT_RESET_SIZE)
+    {
+        fclose(screen);
+        free(term.text);
+
+        if (open_screen() == -1)
+            return;
+    }
+
+    if (!term.tty)
+        return;
+
+    term.line_row = -1;
+
+    if (terminal_size(&rows, &cols) == 0 && (rows != term.rows || cols != term.cols))
+        resize(rows, cols);
+    else
+        frame_blank(&term.back);
+}
+
+void render_clear(void)
+{
+    nsec start = probe_start();
+
+    clear_screen();
+    probe_end(PROBE_CLEAR, start);
+}
+
+static void present_from(int top)
+{ /* envia as diferenças entre <back> e <front> a partir da linha <top> */
+    wchar_t *front, *back;
+    int first, last;
+
+    for (int row = top; row < term.rows; row++)
+    {
+        front = term.front.cell + row * term.cols;
+        back = term.back.cell + row * term.cols;
+
+        for (first = 0; first < term.cols && front[first] == back[first]; first++)
+            ;
+
+        if (first == term.cols)
+            continue;
+
+        for (last = term.cols - 1; front[last] == back[last]; last--)
+            ;
+
+        if (back[first] == WIDE_TAIL && first > 0)
+            first--; /* reescreve o caractere largo inteiro */
+
+        out_move(row, first);
+
+        for (int col = first; col <= last; col++)
+            if (back[col] != WIDE_TAIL)
+                out_char(back[col]);
+
+        wmemcpy(front + first, back + first, last - first + 1);
+    }
+
+    out_move(term.back.row, term.back.col);
+
+    term.front.row = term.back.row;
+    term.front.col = term.back.col;
+
+    out_write();
+}
+
+void render_present(void)
+{
+    if (screen == NULL)
+        return;
+
+    fflush(screen);
+
+    if (!term.tty)
+    { /* sem terminal: apenas repassa o texto */
+        for (; term.consumed < term.text_len; term.consumed++)
+            out_char(term.text[term.consumed]);
+
+        out_write();
+        return;
+    }
+
+    for (; term.consumed < term.text_len; term.consumed++)
+        frame_put(&term.back, term.text[term.consumed]);
+
+    present_from(0);
+}
+
+/*
+ *  Registra <line>, já ecoada pelo terminal seguida de quebra de linha,
+ *  tanto no quadro exibido quanto no próximo, para que não seja redesenhada.
+ */
+
+void render_echo(const wchar_t *line)
+{
+    if (screen == NULL || !term.echo)
+        return;
+
+    for (const wchar_t *c = line; *c != 0; c++)
+        frame_put(&term.front, *c);
+
+    frame_put(&term.front, L'\n');
+
+    fputws(line, screen);
+    putwc(L'\n', screen);
+}
+
+int render_interactive(void)
+{ /* terminal na entrada e na saída: ver <render_line()> */
+    return term.echo;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Reescreve a linha em edição (ver <editor_read()>) com <text>, a partir
+ *  da posição em que a primeira chamada a encontrou, depois do texto já
+ *  escrito em <screen>. Só as células alteradas (os dígitos do relógio, o
+ *  caractere digitado) chegam ao terminal; o restante da tela nem é
+ *  comparado. <render_line_end()> encerra a linha com uma quebra.
+ *
+ *  Sem terminal (ver <render_interactive()>), não faz nada.
+ */
+
+void render_line(const wchar_t *text)
+{
+    int top = term.line_row;
+
+    if (screen == NULL || !term.echo)
+        return;
+
+    fflush(screen);
+
+    if (term.line_row == -1)
+    {
+        for (; term.consumed < term.text_len; term.consumed++)
+            frame_put(&term.back, term.text[term.consumed]);
+
+        term.line_row = term.back.row;
+        term.line_col = term.back.col;
+    }
+    else
+    {
+        term.back.row = term.line_row;
+        term.back.col = term.line_col;
+        wmemset(term.back.cell + term.line_row * term.cols + term.line_col, L' ', (term.rows - term.line_row) * term.cols - term.line_col);
+    }
+
+    for (const wchar_t *c = text; *c != 0; c++)
+        frame_put(&term.back, *c);
+
+    present_from((top != -1 && top == term.line_row)? top: 0); /* se o quadro rolou, tudo mudou de lugar */
+}
+
+void render_line_end(void)
+{
+    if (screen == NULL || !term.echo || term.line_row == -1)
+        return;
+
+    frame_put(&term.back, L'\n');
+    term.line_row = -1;
+
+    render_present();
+}
+
+void render_end(void)
+{
+    if (screen == NULL)
+        return;
+
+    render_present();
+
+    fclose(screen);
+    screen = NULL;
+
+    free(term.text);
+    free(term.front.cell);
+    free(term.back.cell);
+    free(term.out);
+
+    memset(&term, 0, sizeof(term));
+}
@@ -0,0 +1,125 @@
+#include <rng.h>
+
+__extension__ typedef unsigned __int128 u128; /* produto de 64 x 64 bits */
+
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+void rng_seed(rng *g, uint64_t seed)
+{ /* splitmix64 nunca leva a um estado todo zerado */
+    for (int i = 0; i < 4; i++)
+        g->s[i] = splitmix64(&seed);
+}
+
+uint64_t rng_next(rng *g)
+{ /* xoshiro256** */
+    uint64_t *s = g->s, result = rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+uint32_t rng_below(rng *g, uint32_t bound)
+{ /* uniforme em [0, bound), <bound> > 0: rejeita só a sobra que causaria viés */
+    uint64_t m = (rng_next(g) >> 32) * bound;
+    uint32_t threshold;
+
+    if ((uint32_t)m < bound)
+    {
+        threshold = -bound % bound;
+
+        while ((uint32_t)m < threshold)
+            m = (rng_next(g) >> 32) * bound;
+    }
+
+    return m >> 32;
+}
+
+int rng_range(rng *g, int lower_bound, int upper_bound)
+{ /* uniforme em [lower_bound, upper_bound) */
+    return lower_bound + (int)rng_below(g, upper_bound - lower_bound);
+}
+
+double rng_unit(rng *g)
+{ /* uniforme em [0, 1), com 53 bits */
+    return (rng_next(g) >> 11) * 0x1.0p-53;
+}
+
+static void below_pair(rng *g, uint64_t bound1, uint64_t bound2, uint64_t *r1, uint64_t *r2)
+{ /* dois sorteios sem viés de um só número, se <bound1> * <bound2> couber em 64 bits */
+    uint64_t product = bound1 * bound2, threshold = 0;
+    uint64_t leftover;
+    u128 m;
+
+    do
+    {
+        m = (u128)rng_next(g) * bound1;
+        *r1 = m >> 64;
+        m = (u128)(uint64_t)m * bound2;
+        *r2 = m >> 64;
+        leftover = (uint64_t)m;
+
+        if (leftover < product && threshold == 0)
+            threshold = -product % product;
+    }
+    while (leftover < threshold);
+}
+
+static void place(int *out, int i, uint64_t j)
+{ /* passo <i> de Fisher-Yates "de dentro para fora", com <j> em [0, i] */
+    out[i] = (j == (uint64_t)i)? i: out[j];
+    out[j] = i;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Preenche <out> com uma permutação uniforme de 0 a <n> - 1 (Fisher-Yates
+ *  "de dentro para fora"), sem alocar nada. As posições são sorteadas aos
+ *  pares, uma multiplicação de 128 bits por par em vez de um número
+ *  aleatório por posição.
+ */
+
+void rng_permutation(rng *g, int *out, int n)
+{
+    uint64_t j, k;
+    int i = 0;
+
+    if (n > 0)
+        out[i++] = 0;
+
+    for (; i + 1 < n; i += 2)
+    {
+        below_pair(g, i + 1, i + 2, &j, &k);
+        place(out, i, j);
+        place(out, i + 1, k);
+    }
+
+    if (i < n)
+        place(out, i, rng_below(g, i + 1));
+}
+
+uint64_t rng_mix(uint64_t seed, uint64_t n)
+{ /* semente derivada de <seed> e de <n> (partida, sala...), independente da ordem em que são pedidas */
+    uint64_t x = seed ^ (n * 0xD1B54A32D192ED03ull);
+
+    return splitmix64(&x);
+}
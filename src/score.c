@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <string.h>
+#include <main.h>
+#include <score.h>
+#include <probe.h>
+
+int init_tally(answer_tally *tally, int players, int answer_size)
+{
+    tally->capacity = 4;
+
+    while (tally->capacity < 2 * (unsigned)players)
+        tally->capacity *= 2;
+
+    tally->keys_capacity = players * (4 * answer_size + 1); /* até 4 bytes por caractere */
+    tally->keys_size = 0;
+
+    tally->slot = malloc(tally->capacity * sizeof(tally_slot));
+    tally->keys = malloc(tally->keys_capacity);
+    tally->player_slot = malloc(players * sizeof(int));
+
+    if (tally->slot == NULL || tally->keys == NULL || tally->player_slot == NULL)
+        return -1;
+
+    tally_reset(tally);
+
+    return 0;
+}
+
+void free_tally(answer_tally *tally)
+{
+    free(tally->slot);
+    free(tally->keys);
+    free(tally->player_slot);
+
+    tally->slot = NULL;
+    tally->keys = NULL;
+    tally->player_slot = NULL;
+}
+
+void tally_reset(answer_tally *tally)
+{
+    for (unsigned i = 0; i < tally->capacity; i++)
+        tally->slot[i].key = -1;
+
+    tally->keys_size = 0;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Normaliza <answer> e a registra como resposta de <player>.
+ *
+ *  - RETORNO:
+ *
+ *  quantos jogadores deram essa resposta até agora, ou -1 caso falte memória.
+ */
+
+int tally_add(answer_tally *tally, int player, const str8 *answer)
+{
+    int start = tally->keys_size, size = 0, grown_capacity;
+    unsigned hash = 2166136261u, i; /* FNV-1a */
+    const char *p = answer->bytes, *end = answer->bytes + answer->size;
+    char *key, *grown;
+    tally_slot *slot;
+
+    if (start + 4 * answer->length + 1 > tally->keys_capacity)
+    { /* só acontece se alguma resposta exceder <answer_size> */
+        grown_capacity = 2 * (start + 4 * answer->length + 1);
+        grown = realloc(tally->keys, grown_capacity);
+
+        if (grown == NULL)
+            return -1;
+
+        tally->keys = grown;
+        tally->keys_capacity = grown_capacity;
+    }
+
+    key = tally->keys + start;
+
+    while (p < end)
+    {
+        if ((unsigned char)*p < 0x80) /* ASCII: sem decodificar */
+            key[size++] = fold_char(*p++);
+        else
+            size += utf8_put(key + size, fold_char(utf8_next(&p)));
+    }
+
+    for (int j = 0; j < size; j++)
+        hash = (hash ^ (unsigned char)key[j]) * 16777619u;
+
+    key[size] = 0;
+
+    for (i = hash & (tally->capacity - 1);; i = (i + 1) & (tally->capacity - 1))
+    {
+        slot = &tally->slot[i];
+
+        if (slot->key == -1)
+        {
+            slot->hash = hash;
+            slot->key = start;
+            slot->size = size;
+            slot->length = answer->length;
+            slot->count = 1;
+
+            tally->keys_size += size + 1;
+            break;
+        }
+
+        if (slot->hash == hash && slot->size == size && memcmp(tally->keys + slot->key, key, size) == 0)
+        {
+            slot->count++;
+            break;
+        }
+    }
+
+    tally->player_slot[player] = i;
+
+    return slot->count;
+}
+
+int tally_count(answer_tally *tally, int player)
+{
+    return tally->slot[tally->player_slot[player]].count;
+}
+
+int tally_length(answer_tally *tally, int player)
+{
+    return tally->slot[tally->player_slot[player]].length;
+}
+
+/*
+ *  Pontua a rodada atual: cada resposta vale seu tamanho dividido pelo
+ *  número de jogadores que deram a mesma resposta, e reposiciona na
+ *  classificação só os jogadores cujo total mudou. O registro no diário
+ *  fica com quem chama (ver <journal_round()>), que decide o que fazer se
+ *  a gravação falhar.
+ *
+ *  Retorna 0 em caso de sucesso e -1 se faltar memória para contar as
+ *  respostas; nesse caso nada foi alterado e a rodada fica sem pontuação.
+ */
+
+static int tally_round(game_data *data)
+{
+    answer_tally *tally = &data->tally;
+    int p, r = data->curr_round, *row, points;
+
+    tally_reset(tally);
+
+    for (p = 0; p < data->number_of_players; p++)
+        if (tally_add(tally, p, data->round_answer[p]) == -1)
+            return -1;
+
+    for (p = 0; p < data->number_of_players; p++)
+    {
+        row = player_scores(data, p);
+        points = round(tally_length(tally, p) / (double) tally_count(tally, p));
+
+        if (points != row[r])
+        {
+            data->total[p] += points - row[r];
+            row[r] = points;
+            scoreboard_set(&data->board, p, r, points, data->total[p]);
+            standings_update(&data->standings, p, data->total[p]);
+        }
+    }
+
+    return 0;
+}
+
+int score_round(game_data *data)
+{
+    nsec start = probe_start();
+    int status = tally_round(data);
+
+    probe_end(PROBE_SCORE, start);
+
+    return status;
+}
@@ -0,0 +1,213 @@
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <scoreboard.h>
+
+static const wchar_t sep[] = L" | ";
+#define SEP_W 3
+
+static int max_len(const wchar_t *const *S, int n)
+{
+    int max = 0, len;
+
+    for (int i = 0; i < n; i++)
+        if ((len = wcslen(S[i])) > max)
+            max = len;
+
+    return max;
+}
+
+static int digits(int n)
+{ /* de <n> >= 0 em decimal */
+    int count = 1;
+
+    while ((n /= 10) > 0)
+        count++;
+
+    return count;
+}
+
+static void put_centered(wchar_t *dst, int width, const wchar_t *s, int len, wchar_t placeholder)
+{ /* mesmo alinhamento de <fcentered()>, mas truncando o que não couber */
+    int remaining;
+
+    if (len > width)
+        len = width;
+
+    remaining = width - len;
+
+    wmemset(dst, placeholder, remaining / 2);
+    wmemcpy(dst + remaining / 2, s, len);
+    wmemset(dst + remaining / 2 + len, placeholder, remaining - remaining / 2);
+}
+
+static void put_int(wchar_t *dst, int width, int n)
+{
+    wchar_t digits[16];
+    int i = sizeof(digits) / sizeof(wchar_t);
+    unsigned u = (n < 0)? -(unsigned)n: (unsigned)n;
+
+    do
+        digits[--i] = L'0' + u % 10;
+    while ((u /= 10) > 0);
+
+    if (n < 0)
+        digits[--i] = L'-';
+
+    put_centered(dst, width, digits + i, sizeof(digits) / sizeof(wchar_t) - i, L' ');
+}
+
+static wchar_t *cell(scoreboard *board, wchar_t *line, int round)
+{ /* início da coluna <round> (ou da primeira, se -1) em <line> */
+    return line + (round < 0? 0: board->first_w + SEP_W + round * (board->cell_w + SEP_W));
+}
+
+static void fill_line(scoreboard *board, wchar_t *line, const wchar_t *first, const wchar_t *const *columns, int column_step, wchar_t placeholder)
+{ /* primeira coluna seguida das de rodada; <columns> com passo 0 repete o mesmo texto */
+    const wchar_t *text;
+
+    put_centered(line, board->first_w, first, wcslen(first), placeholder);
+
+    for (int r = 0; r < board->rounds; r++)
+    {
+        text = columns[r * column_step];
+        wmemcpy(cell(board, line, r) - SEP_W, sep, SEP_W);
+        put_centered(cell(board, line, r), board->cell_w, text, wcslen(text), placeholder);
+    }
+
+    wmemcpy(line + board->line_w - SEP_W, sep, SEP_W);
+}
+
+int scoreboard_init(scoreboard *board, int players, int rounds, int name_size, int max_total,
+                    const wchar_t *names, const wchar_t *const *columns)
+{ /* <names>: um nome a cada <name_size> + 1 caracteres; <max_total>: maior total possível */
+    static const wchar_t *const nome[] = {L"Nome"}, *const de[] = {L"de"};
+    size_t table_size;
+
+    board->players = players;
+    board->rounds = rounds;
+    board->first_w = (name_size > 7)? name_size: 7; /* "Jogador" */
+    board->cell_w = max_len(columns, rounds);
+
+    if (board->cell_w < 7) /* "Parcial" */
+        board->cell_w = 7;
+
+    if (board->cell_w < digits(max_total))
+        board->cell_w = digits(max_total);
+    board->line_w = board->first_w + SEP_W + rounds * (board->cell_w + SEP_W);
+
+    /* nunca se exibem mais que SCOREBOARD_TOP jogadores */
+    table_size = (SCOREBOARD_HEADER_LINES + (players < SCOREBOARD_TOP? players: SCOREBOARD_TOP)) * (board->line_w + board->cell_w + 1) + 1;
+
+    board->header = malloc(SCOREBOARD_HEADER_LINES * board->line_w * sizeof(wchar_t));
+    board->header_last = malloc(SCOREBOARD_HEADER_LINES * board->cell_w * sizeof(wchar_t));
+    board->rows = malloc(players * board->line_w * sizeof(wchar_t));
+    board->totals = malloc(players * board->cell_w * sizeof(wchar_t));
+    board->table = malloc(table_size * sizeof(wchar_t));
+
+    if (board->header == NULL || board->header_last == NULL || board->rows == NULL || board->totals == NULL || board->table == NULL)
+    {
+        scoreboard_free(board);
+        return -1;
+    }
+
+    fill_line(board, board->header, L"", nome, 0, L' ');
+    fill_line(board, board->header + board->line_w, L"Jogador", de, 0, L' ');
+    fill_line(board, board->header + 2 * board->line_w, L"", columns, 1, L' ');
+    wmemset(board->header + 3 * board->line_w, L'*', board->line_w);
+
+    put_centered(board->header_last, board->cell_w, L"", 0, L' ');
+    put_centered(board->header_last + board->cell_w, board->cell_w, L"Total", 5, L' ');
+    put_centered(board->header_last + 2 * board->cell_w, board->cell_w, L"Parcial", 7, L' ');
+    wmemset(board->header_last + 3 * board->cell_w, L'*', board->cell_w);
+
+    for (int p = 0; p < players; p++)
+    {
+        wchar_t *line = board->rows + p * board->line_w;
+
+        const wchar_t *name = names + p * (name_size + 1);
+
+        put_centered(line, board->first_w, name, wcslen(name), L' ');
+
+        for (int r = 0; r < rounds; r++)
+        {
+            wmemcpy(cell(board, line, r) - SEP_W, sep, SEP_W);
+            put_int(cell(board, line, r), board->cell_w, 0);
+        }
+
+        wmemcpy(line + board->line_w - SEP_W, sep, SEP_W);
+        put_int(board->totals + p * board->cell_w, board->cell_w, 0);
+    }
+
+    return 0;
+}
+
+void scoreboard_set(scoreboard *board, int player, int round, int score, int total)
+{ /* reformata a célula da rodada e o total de <player> */
+    put_int(cell(board, board->rows + player * board->line_w, round), board->cell_w, score);
+    put_int(board->totals + player * board->cell_w, board->cell_w, total);
+}
+
+static wchar_t *put_row(scoreboard *board, wchar_t *out, const wchar_t *line, const wchar_t *last, int prefix)
+{ /* prefixo de <line> até a rodada exibida, última coluna e quebra de linha */
+    wmemcpy(out, line, prefix);
+    wmemcpy(out + prefix, last, board->cell_w);
+    out += prefix + board->cell_w;
+    *out++ = L'\n';
+
+    return out;
+}
+
+static int prefix_w(scoreboard *board, int round)
+{
+    return board->first_w + SEP_W + (round + 1) * (board->cell_w + SEP_W);
+}
+
+void scoreboard_render(FILE *stream, scoreboard *board, const int *order, int rows, int round)
+{ /* cabeçalho e as linhas dos <rows> jogadores em <order> */
+    int prefix = prefix_w(board, round), p;
+    wchar_t *out = board->table;
+
+    if (round < 0 || round >= board->rounds)
+        return;
+
+    if (rows > SCOREBOARD_TOP)
+        rows = SCOREBOARD_TOP;
+
+    for (int i = 0; i < SCOREBOARD_HEADER_LINES; i++)
+        out = put_row(board, out, board->header + i * board->line_w, board->header_last + i * board->cell_w, prefix);
+
+    for (int i = 0; i < rows; i++)
+    {
+        p = order[i];
+        out = put_row(board, out, board->rows + p * board->line_w, board->totals + p * board->cell_w, prefix);
+    }
+
+    *out = 0;
+
+    fputws(board->table, stream);
+}
+
+void scoreboard_render_row(FILE *stream, scoreboard *board, int player, int round)
+{ /* só a linha de <player>, sem cabeçalho */
+    wchar_t *out;
+
+    if (round < 0 || round >= board->rounds)
+        return;
+
+    out = put_row(board, board->table, board->rows + player * board->line_w, board->totals + player * board->cell_w, prefix_w(board, round));
+    *out = 0;
+
+    fputws(board->table, stream);
+}
+
+void scoreboard_free(scoreboard *board)
+{
+    free(board->header);
+    free(board->header_last);
+    free(board->rows);
+    free(board->totals);
+    free(board->table);
+
+    memset(board, 0, sizeof(scoreboard));
+}
@@ -0,0 +1,1352 @@
+#define _GNU_SOURCE /* accept4() */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <main.h>
+#include <server.h>
+#include <reader.h>
+#include <probe.h>
+
+#define MAX_EVENTS 256
+#define READS_PER_EVENT 16     /* leituras por evento, para uma conexão inundada não monopolizar o laço */
+#define OUTPUT_LIMIT (1 << 20) /* saída pendente máxima por conexão antes de derrubá-la */
+#define INTERMISSION 3         /* segundos de pausa entre rodadas */
+#define FLUSH_INTERVAL 1       /* segundos entre gravações do diário, do ranking e das medidas */
+#define LINGER 5               /* segundos para o cliente fechar uma conexão encerrada antes de ela ser derrubada */
+
+/*
+ *  Toda estrutura registrada no <epoll> começa com um <event_source>,
+ *  de modo que o ponteiro devolvido em <epoll_event.data.ptr> identifica
+ *  o tipo do evento antes de ser convertido.
+ */
+
+typedef enum { SOURCE_LISTENER, SOURCE_CONNECTION, SOURCE_TIMER, SOURCE_SIGNAL } source_type;
+
+typedef struct {
+    source_type type;
+    int fd; /* -1 após fechado, para eventos pendentes do mesmo lote serem ignorados */
+} event_source;
+
+struct room;
+
+typedef enum { CONN_NAMING, CONN_WAITING, CONN_PLAYING } conn_state;
+
+typedef struct connection {
+    event_source source;
+    conn_state state;
+
+    struct room *room;
+    int seat;
+    wchar_t *name;
+
+    line_reader in; /* guarda só o início de cada linha; o excedente é descartado */
+
+    char *out;
+    size_t out_len;
+    size_t out_sent;
+    size_t out_cap;
+    int want_write;
+    int closing; /* encerra a escrita assim que a saída pendente for enviada */
+    int doomed;  /* fechamento adiado para o fim do lote de eventos */
+    timer_entry linger; /* prazo de <closing>, em <server.lingering> */
+
+    struct connection *next_doomed;
+    struct connection *next_dead;
+} connection;
+
+typedef enum { ROOM_FILLING, ROOM_TURN, ROOM_COLLECT, ROOM_INTERMISSION } room_state; /* ROOM_COLLECT: rodada simultânea */
+
+typedef struct room {
+    timer_entry timer; /* primeiro campo: a entrada expirada identifica a sala */
+    room_state state;
+    int dead;
+
+    game_data data;
+
+    connection **seat;
+    int seated;
+    int present;
+
+    nsec turn_start;
+    int pending; /* respostas que a rodada simultânea ainda espera */
+    str8 *bot_answer; /* do robô da vez, dada quando o timer da sala disparar */
+
+    struct room *next_dead;
+} room;
+
+typedef struct {
+    int epoll_fd;
+    event_source listener;
+    event_source clock;  /* <timerfd> de <timers> */
+    event_source signals; /* <signalfd> de SIGHUP (recarrega o pacote) e SIGUSR1 (grava as medidas) */
+    timer_queue timers; /* prazos de todas as salas */
+    event_source linger_clock; /* <timerfd> de <lingering> */
+    timer_queue lingering;     /* prazos das conexões encerradas (ver LINGER) */
+    const server_options *options;
+    int humans_per_room; /* os demais assentos são de robôs */
+    game_config *config; /* pacote das próximas salas; as já abertas seguram o seu */
+    FILE *sink;          /* motivos de recusa das respostas dos robôs, descartados */
+    journal *journal;
+    leaderboard *leaderboard;
+    timer_entry flush_tick; /* grava diário, ranking e medidas; as demais entradas de <timers> são salas */
+
+    room *filling;
+    int active_rooms;
+    uint64_t games; /* salas já formadas: a próxima joga com <rng_mix(options->seed, games)> */
+
+    connection *doomed_connections;
+    connection *dead_connections;
+    room *dead_rooms;
+} server;
+
+static void room_begin_turn(server *srv, room *r);
+static void room_begin_collect(server *srv, room *r);
+
+/* ------------------------------------------------------------------ */
+/* conexões                                                            */
+/* ------------------------------------------------------------------ */
+
+static void conn_watch(server *srv, connection *c, int want_write)
+{
+    struct epoll_event ev;
+
+    if (c->want_write == want_write)
+        return;
+
+    ev.events = EPOLLIN | EPOLLRDHUP | (want_write? EPOLLOUT: 0);
+    ev.data.ptr = &c->source;
+
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, c->source.fd, &ev);
+
+    c->want_write = want_write;
+}
+
+static void room_leave(server *srv, connection *c);
+static void room_collect(server *srv, room *r, int player, str8 *answer, nsec used);
+
+/*
+ *  Conexões com erro não são fechadas no meio da lógica de uma sala,
+ *  pois isso pode encerrá-la enquanto ainda está em uso; são marcadas
+ *  aqui e fechadas por <conn_drop()> ao fim do lote de eventos.
+ */
+
+static void conn_kill(server *srv, connection *c)
+{
+    if (c->doomed)
+        return;
+
+    c->doomed = 1;
+    c->next_doomed = srv->doomed_connections;
+    srv->doomed_connections = c;
+}
+
+static void conn_drop(server *srv, connection *c)
+{
+    if (c->source.fd == -1)
+        return;
+
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, c->source.fd, NULL);
+    close(c->source.fd);
+    c->source.fd = -1;
+    timer_cancel(&srv->lingering, &c->linger);
+
+    if (c->room != NULL)
+        room_leave(srv, c);
+
+    c->next_dead = srv->dead_connections;
+    srv->dead_connections = c;
+}
+
+static void conn_flush(server *srv, connection *c)
+{
+    ssize_t n;
+
+    while (c->out_sent < c->out_len)
+    {
+        n = send(c->source.fd, c->out + c->out_sent, c->out_len - c->out_sent, MSG_NOSIGNAL);
+
+        if (n > 0)
+            c->out_sent += n;
+        else if (n == -1 && errno == EINTR)
+            continue;
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            conn_watch(srv, c, 1);
+            return;
+        }
+        else
+        {
+            conn_kill(srv, c);
+            return;
+        }
+    }
+
+    c->out_len = c->out_sent = 0;
+    conn_watch(srv, c, 0);
+
+    if (c->closing) /* fechar com entrada não lida faria o kernel descartar */
+        shutdown(c->source.fd, SHUT_WR); /* o que falta enviar; espera o cliente fechar */
+}
+
+static void conn_close(server *srv, connection *c)
+{ /* encerra após a saída pendente; se o cliente não fechar sua ponta em LINGER segundos, é derrubado */
+    c->closing = 1;
+
+    if (timer_set(&srv->lingering, &c->linger, timer_now() + seconds_to_ns(LINGER)) == -1)
+    {
+        conn_kill(srv, c);
+        return;
+    }
+
+    if (!c->want_write)
+        conn_flush(srv, c);
+}
+
+static void conn_send(server *srv, connection *c, const char *bytes, size_t n)
+{
+    char *grown;
+    size_t cap;
+
+    if (c->doomed || n == 0)
+        return;
+
+    if (c->out_len + n > c->out_cap)
+    {
+        if (c->out_len - c->out_sent + n > OUTPUT_LIMIT)
+        { /* cliente não está lendo; não há por que acumular indefinidamente */
+            conn_kill(srv, c);
+            return;
+        }
+
+        for (cap = c->out_cap? c->out_cap: 1024; cap < c->out_len + n; cap *= 2)
+            ;
+
+        grown = realloc(c->out, cap);
+
+        if (grown == NULL)
+        {
+            conn_kill(srv, c);
+            return;
+        }
+
+        c->out = grown;
+        c->out_cap = cap;
+    }
+
+    memcpy(c->out + c->out_len, bytes, n);
+    c->out_len += n;
+
+    if (!c->want_write)
+        conn_flush(srv, c);
+}
+
+/*
+ *  Texto destinado aos clientes é escrito num fluxo largo em memória,
+ *  para que <show_scores()> e afins possam ser reaproveitadas, e só ao
+ *  fechá-lo é convertido para bytes na codificação do locale (UTF-8).
+ */
+
+typedef struct {
+    FILE *stream;
+    wchar_t *buffer;
+    size_t len;
+} text_buffer;
+
+static FILE *text_open(text_buffer *t)
+{
+    t->buffer = NULL;
+    t->stream = open_wmemstream(&t->buffer, &t->len);
+
+    return t->stream;
+}
+
+static char *text_close(text_buffer *t, size_t *len)
+{ /* devolve os bytes alocados e seu tamanho em <len>, ou NULL */
+    char *bytes = NULL;
+    size_t n;
+
+    fclose(t->stream);
+
+    n = wcstombs(NULL, t->buffer, 0);
+
+    if (n != (size_t)-1 && (bytes = malloc(n + 1)) != NULL)
+    {
+        wcstombs(bytes, t->buffer, n + 1);
+        *len = n;
+    }
+
+    free(t->buffer);
+
+    return bytes;
+}
+
+static char *vformat(size_t *len, const wchar_t *format, va_list ap)
+{
+    text_buffer t;
+
+    if (text_open(&t) == NULL)
+        return NULL;
+
+    vfwprintf(t.stream, format, ap);
+
+    return text_close(&t, len);
+}
+
+static void conn_printf(server *srv, connection *c, const wchar_t *format, ...)
+{
+    char *text;
+    size_t len;
+    va_list ap;
+
+    va_start(ap, format);
+    text = vformat(&len, format, ap);
+    va_end(ap);
+
+    if (text != NULL)
+        conn_send(srv, c, text, len);
+
+    free(text);
+}
+
+static void room_send(server *srv, room *r, const char *bytes, size_t len)
+{
+    for (int i = 0; i < r->seated; i++)
+        if (r->seat[i] != NULL)
+            conn_send(srv, r->seat[i], bytes, len);
+}
+
+static void room_printf(server *srv, room *r, const wchar_t *format, ...)
+{
+    char *text;
+    size_t len;
+    va_list ap;
+
+    va_start(ap, format);
+    text = vformat(&len, format, ap);
+    va_end(ap);
+
+    if (text != NULL)
+        room_send(srv, r, text, len);
+
+    free(text);
+}
+
+static wchar_t *decode_line(arena *a, const line_reader *in)
+{ /* converte linha recebida para texto largo e apara espaços; NULL se inválida */
+    wchar_t raw[READER_LINE], *text;
+    nsec start = probe_start();
+    int size = reader_decode(in, raw);
+
+    probe_end(PROBE_DECODE, start);
+
+    if (size == -1)
+        return NULL;
+
+    start = probe_start();
+    text = trim_wstring(a, raw);
+    probe_end(PROBE_TRIM, start);
+
+    return text;
+}
+
+/* ------------------------------------------------------------------ */
+/* salas                                                               */
+/* ------------------------------------------------------------------ */
+
+static void room_close(server *srv, room *r);
+
+static void room_arm(server *srv, room *r, nsec deadline)
+{ /* sem memória para o prazo, a sala esperaria para sempre: é encerrada */
+    if (timer_set(&srv->timers, &r->timer, deadline) == 0)
+        return;
+
+    room_printf(srv, r, L"\n\tServidor sem recursos para continuar a partida.\n");
+    room_close(srv, r);
+}
+
+static void room_schedule(server *srv, room *r, double sec)
+{
+    room_arm(srv, r, timer_now() + seconds_to_ns(sec));
+}
+
+static void room_bind(server *srv, room *r)
+{ /* partida ainda por começar, com o pacote atual do servidor */
+    game_data data = new_game(srv->config);
+
+    memcpy(&r->data, &data, sizeof(game_data));
+    r->data.number_of_players = srv->options->players_per_room;
+    r->data.journal = srv->journal;
+    r->data.leaderboard = srv->leaderboard;
+    r->data.bots = srv->options->bots;
+    r->data.bot_profile = &srv->options->bot;
+}
+
+static room *room_new(server *srv)
+{
+    room *r = calloc(1, sizeof(room));
+
+    if (r == NULL)
+        return NULL;
+
+    room_bind(srv, r);
+
+    r->seat = calloc(srv->options->players_per_room, sizeof(connection *));
+    timer_entry_init(&r->timer);
+
+    if (r->seat == NULL)
+    {
+        config_release(r->data.config);
+        free(r);
+        return NULL;
+    }
+
+    srv->active_rooms++;
+
+    return r;
+}
+
+static void room_free(server *srv, room *r)
+{
+    if (r->dead)
+        return;
+
+    r->dead = 1;
+    timer_cancel(&srv->timers, &r->timer);
+
+    for (int i = 0; i < r->seated; i++)
+        if (r->seat[i] != NULL)
+            r->seat[i]->room = NULL;
+
+    if (r->state != ROOM_FILLING)
+        free_game(&r->data);
+    else
+        config_release(r->data.config);
+
+    if (srv->filling == r)
+        srv->filling = NULL;
+
+    srv->active_rooms--;
+
+    r->next_dead = srv->dead_rooms;
+    srv->dead_rooms = r;
+}
+
+static void room_leave(server *srv, connection *c)
+{
+    room *r = c->room;
+
+    c->room = NULL;
+
+    if (r->state == ROOM_FILLING)
+    { /* ainda não começou: libera o assento */
+        for (int i = c->seat; i < r->seated - 1; i++)
+        {
+            r->seat[i] = r->seat[i + 1];
+            r->seat[i]->seat = i;
+        }
+
+        r->seated--;
+        return;
+    }
+
+    r->seat[c->seat] = NULL;
+    r->present--;
+
+    if (r->present == 0)
+        room_free(srv, r);
+    else if (r->state == ROOM_TURN && r->data.players_sequence[r->data.curr_turn] == c->seat)
+    { /* jogador da vez saiu: encerra seu turno sem resposta */
+        charge_turn(&r->data, c->seat, seconds_to_ns(player_total_time(&r->data)));
+        r->data.round_answer[c->seat] = r->data.no_answer;
+        r->data.curr_turn++;
+        room_begin_turn(srv, r);
+    }
+    else if (r->state == ROOM_COLLECT && r->data.round_answer[c->seat] == NULL)
+    { /* saiu antes de responder: fica sem resposta, e a rodada não espera por ele */
+        room_collect(srv, r, c->seat, r->data.no_answer, r->data.curr_time_left - r->turn_start);
+    }
+}
+
+static void room_send_stream(server *srv, room *r, void (*show)(FILE *, game_data *))
+{
+    text_buffer t;
+    char *text;
+    size_t len;
+
+    if (text_open(&t) == NULL)
+        return;
+
+    show(t.stream, &r->data);
+
+    if ((text = text_close(&t, &len)) != NULL)
+        room_send(srv, r, text, len);
+
+    free(text);
+}
+
+static void room_send_standings(server *srv, room *r)
+{ /* nas salas grandes, cada jogador recebe a própria linha abaixo da tabela comum */
+    text_buffer t;
+    char *text;
+    size_t len;
+
+    if (r->data.number_of_players <= SCOREBOARD_TOP)
+        return;
+
+    for (int i = 0; i < r->seated; i++)
+    {
+        if (r->seat[i] == NULL || text_open(&t) == NULL)
+            continue;
+
+        show_standing(t.stream, &r->data, i);
+
+        if ((text = text_close(&t, &len)) != NULL)
+            conn_send(srv, r->seat[i], text, len);
+
+        free(text);
+    }
+}
+
+static void room_begin_round(server *srv, room *r)
+{
+    game_data *data = &r->data;
+
+    draw_turn_order(data);
+
+    room_printf(srv, r, L"\nRodada %02d\n\nLetra da rodada: %C\n\nCategoria da rodada: %S\n",
+                data->curr_round + 1,
+                data->letters[data->letters_sequence[data->curr_round]],
+                data->categories[data->categories_sequence[data->curr_round]]);
+
+    data->curr_turn = 0;
+
+    if (srv->options->simultaneous)
+    {
+        room_begin_collect(srv, r);
+        return;
+    }
+
+    room_printf(srv, r, L"\nOrdem da rodada:\n");
+    room_send_stream(srv, r, show_players);
+
+    room_begin_turn(srv, r);
+}
+
+static void room_prompt(server *srv, room *r, int player)
+{ /* com o tempo que ainda resta até o prazo do turno (ou da rodada simultânea) */
+    game_data *data = &r->data;
+    nsec start = probe_start();
+
+    conn_printf(srv, r->seat[player], L"\n%S, você tem %.2lf segundo(s) para inserir palavra na categoria \"%S\" começando com \"%C\": ",
+                player_name(data, player),
+                time_left(data->curr_time_left),
+                data->categories[data->categories_sequence[data->curr_round]],
+                data->letters[data->letters_sequence[data->curr_round]]);
+
+    probe_end(PROBE_PROMPT, start);
+}
+
+static void room_close(server *srv, room *r)
+{ /* despede os jogadores restantes, fechando após a última mensagem */
+    connection *c;
+
+    for (int i = 0; i < r->seated; i++)
+    {
+        if ((c = r->seat[i]) == NULL)
+            continue;
+
+        c->room = NULL;
+        conn_close(srv, c);
+    }
+
+    room_free(srv, r);
+}
+
+static void room_finish(server *srv, room *r)
+{
+    game_data *data = &r->data;
+    int winner = victor(data);
+    text_buffer t;
+    char *text;
+    size_t len;
+
+    seat_order(data);
+
+    if (data->leaderboard != NULL && leaderboard_game(data->leaderboard, data, winner) == -1)
+        data->leaderboard = NULL; /* sem memória: a partida fica fora do ranking */
+
+    if (text_open(&t) != NULL)
+    {
+        fputws(L"\nRESULTADO FINAL:\n", t.stream);
+        show_scores(t.stream, data);
+        fwprintf(t.stream, L"\n\nVencedor: %S.\n", player_name(data, winner));
+        show_ranking(t.stream, data);
+
+        if ((text = text_close(&t, &len)) != NULL)
+            room_send(srv, r, text, len);
+
+        free(text);
+    }
+
+    room_send_standings(srv, r);
+    room_close(srv, r);
+}
+
+static void room_end_round(server *srv, room *r)
+{
+    game_data *data = &r->data;
+
+    if (score_round(data) == -1)
+    { /* sem memória: a partida não tem como seguir com escores certos */
+        room_printf(srv, r, L"\n\tFalha ao pontuar a rodada.\n");
+        room_close(srv, r);
+        return;
+    }
+
+    if (data->journal != NULL && journal_round(data->journal, data) == -1)
+        fwprintf(stderr, L"Rodada %d da partida %llu fora do diário (errno == %d).\n", data->curr_round + 1, (unsigned long long)data->game_id, errno);
+
+    room_printf(srv, r, L"\n");
+    room_send_stream(srv, r, show_answers);
+    arena_reset(&data->round_arena); /* respostas da rodada já não são usadas */
+    room_printf(srv, r, L"\n\nConcluída a rodada, esta é a tabela de escores:\n\n");
+    room_send_stream(srv, r, show_scores);
+    room_send_standings(srv, r);
+
+    if (data->curr_round + 1 == data->rounds)
+    {
+        room_finish(srv, r);
+        return;
+    }
+
+    room_printf(srv, r, L"\nPróxima rodada em %d segundos...\n", INTERMISSION);
+
+    r->state = ROOM_INTERMISSION;
+    room_schedule(srv, r, INTERMISSION);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Começa uma rodada simultânea (ver <server_options.simultaneous>): todos
+ *  recebem o prompt de uma vez, com um único prazo, o que o primeiro da
+ *  vez teria no modo por turnos. Os robôs decidem já; as respostas dos
+ *  humanos são guardadas à medida que chegam (ver <room_collect()>), e a
+ *  rodada é pontuada no prazo, ou antes, se todos já tiverem respondido.
+ */
+
+static void room_begin_collect(server *srv, room *r)
+{
+    game_data *data = &r->data;
+    double latency;
+    str8 *answer;
+    int player;
+
+    r->state = ROOM_COLLECT;
+    r->turn_start = timer_now();
+    data->curr_time_left = r->turn_start + seconds_to_ns(player_total_time(data));
+    r->pending = 0;
+
+    for (int i = 0; i < data->number_of_players; i++)
+    { /* na ordem sorteada, que é a da exibição das respostas e a dos sorteios dos robôs */
+        player = data->players_sequence[i];
+        data->round_answer[player] = NULL;
+
+        if (is_bot(data, player))
+        {
+            if ((answer = bot_turn(srv->sink, data, time_left(data->curr_time_left), &latency)) == NULL)
+                answer = data->no_answer;
+
+            data->round_answer[player] = answer;
+            charge_turn(data, player, seconds_to_ns(latency));
+        }
+        else if (r->seat[player] == NULL)
+        {
+            data->round_answer[player] = data->no_answer;
+            charge_turn(data, player, data->curr_time_left - r->turn_start);
+        }
+        else
+        {
+            r->pending++;
+            room_prompt(srv, r, player);
+        }
+    }
+
+    if (r->pending == 0)
+    {
+        room_end_round(srv, r);
+        return;
+    }
+
+    room_arm(srv, r, data->curr_time_left);
+}
+
+static void room_collect(server *srv, room *r, int player, str8 *answer, nsec used)
+{ /* guarda a resposta de <player> na rodada simultânea */
+    game_data *data = &r->data;
+
+    data->round_answer[player] = answer;
+    charge_turn(data, player, used);
+
+    if (--r->pending > 0)
+        return;
+
+    timer_cancel(&srv->timers, &r->timer);
+    room_end_round(srv, r);
+}
+
+static void room_begin_turn(server *srv, room *r)
+{
+    game_data *data = &r->data;
+    int player;
+
+    /* jogadores desconectados perdem a vez sem esperar o tempo */
+    while (data->curr_turn < data->number_of_players && r->seat[player = data->players_sequence[data->curr_turn]] == NULL && !is_bot(data, player))
+    {
+        data->round_answer[player] = data->no_answer;
+        charge_turn(data, player, seconds_to_ns(player_total_time(data)));
+        data->curr_turn++;
+    }
+
+    if (data->curr_turn == data->number_of_players)
+    {
+        room_end_round(srv, r);
+        return;
+    }
+
+    for (int i = 0; i < r->seated; i++)
+        if (r->seat[i] != NULL && i != player)
+            conn_printf(srv, r->seat[i], L"\nVez de %S...\n", player_name(data, player));
+
+    r->state = ROOM_TURN;
+    r->turn_start = timer_now();
+    data->curr_time_left = r->turn_start + seconds_to_ns(player_total_time(data));
+
+    if (is_bot(data, player))
+    { /* decide já, mas só responde quando passar o tempo que levaria */
+        double latency;
+
+        r->bot_answer = bot_turn(srv->sink, data, time_left(data->curr_time_left), &latency);
+        room_arm(srv, r, (r->bot_answer == NULL)? data->curr_time_left: r->turn_start + seconds_to_ns(latency));
+        return;
+    }
+
+    room_arm(srv, r, data->curr_time_left);
+
+    if (!r->dead)
+        room_prompt(srv, r, player);
+}
+
+static void room_end_turn(server *srv, room *r, str8 *answer, nsec used)
+{
+    game_data *data = &r->data;
+    int player = data->players_sequence[data->curr_turn];
+
+    timer_cancel(&srv->timers, &r->timer);
+
+    data->round_answer[player] = answer;
+    charge_turn(data, player, used);
+    data->curr_turn++;
+
+    room_begin_turn(srv, r);
+}
+
+static void room_answer(server *srv, room *r, connection *c, str8 *answer)
+{
+    game_data *data = &r->data;
+    nsec now = timer_now(), used = now - r->turn_start;
+    text_buffer t;
+    char *text;
+    size_t len;
+
+    if (now >= data->curr_time_left)
+    { /* timer já disparou e será tratado neste mesmo lote */
+        arena_pop(&data->round_arena, answer);
+        return;
+    }
+
+    if (probe_enabled) /* espera do jogador: do início do turno até a chegada da resposta */
+        probe_record(PROBE_WAIT, used);
+
+    if (text_open(&t) == NULL)
+    {
+        arena_pop(&data->round_arena, answer);
+        return;
+    }
+
+    if (validate_size(t.stream, answer->length, 1, data->answer_size) && check_answer(t.stream, data, answer))
+    {
+        free(text_close(&t, &len));
+
+        if (r->state == ROOM_TURN)
+        {
+            room_end_turn(srv, r, answer, used);
+            return;
+        }
+
+        conn_printf(srv, c, L"\nResposta registrada; aguarde o fim da rodada.\n");
+        room_collect(srv, r, c->seat, answer, used);
+        return;
+    }
+
+    arena_pop(&data->round_arena, answer);
+
+    if ((text = text_close(&t, &len)) != NULL)
+        conn_send(srv, c, text, len);
+
+    free(text);
+
+    room_prompt(srv, r, c->seat);
+}
+
+static void room_join(server *srv, connection *c)
+{
+    room *r = srv->filling;
+    game_data *data;
+
+    if (r == NULL && (r = srv->filling = room_new(srv)) == NULL)
+    {
+        conn_printf(srv, c, L"\n\tServidor sem recursos para novas salas.\n");
+        conn_close(srv, c);
+        return;
+    }
+
+    c->room = r;
+    c->seat = r->seated;
+    c->state = CONN_WAITING;
+    r->seat[r->seated++] = c;
+
+    room_printf(srv, r, L"\n%S entrou na sala (%d/%d).\n", c->name, r->seated, srv->humans_per_room);
+
+    if (r->seated < srv->humans_per_room)
+        return;
+
+    /* sala cheia: o jogo copia os nomes, que continuam com as conexões */
+    srv->filling = NULL;
+    data = &r->data;
+    r->state = ROOM_TURN; /* a partir daqui <room_free()> libera o jogo */
+    data->seed = rng_mix(srv->options->seed, srv->games++);
+
+    wchar_t *names[r->seated];
+
+    for (int i = 0; i < r->seated; i++)
+    {
+        names[i] = r->seat[i]->name;
+        r->seat[i]->state = CONN_PLAYING;
+    }
+
+    if (init_game(data, names) == -1)
+    {
+        room_printf(srv, r, L"\n\tFalha ao iniciar o jogo.\n");
+        room_close(srv, r);
+        return;
+    }
+
+    r->present = r->seated;
+    data->curr_round = 0;
+
+    room_begin_round(srv, r);
+}
+
+/* ------------------------------------------------------------------ */
+/* eventos                                                             */
+/* ------------------------------------------------------------------ */
+
+static int room_awaits(const room *r, int seat)
+{ /* a sala espera uma resposta de <seat> agora */
+    if (r->state == ROOM_COLLECT)
+        return r->data.round_answer[seat] == NULL;
+
+    return r->state == ROOM_TURN && r->data.players_sequence[r->data.curr_turn] == seat;
+}
+
+static void handle_line(server *srv, connection *c)
+{
+    wchar_t *text;
+    str8 *answer;
+    room *r = c->room;
+    game_data *data;
+
+    if (c->closing || c->doomed)
+        return;
+
+    if (c->in.overflow && c->state == CONN_NAMING)
+    {
+        conn_printf(srv, c, L"\n\tNome deve ter entre 1 e %d caracteres!\n\nNome do jogador: ", srv->config->name_size);
+        return;
+    }
+
+    if (c->in.overflow && r != NULL && room_awaits(r, c->seat))
+    {
+        conn_printf(srv, c, L"\n\tEntrada não deve exceder %d caracteres!\n", r->data.answer_size);
+        room_prompt(srv, r, c->seat);
+        return;
+    }
+
+    switch (c->state)
+    {
+    case CONN_NAMING:
+        if ((text = decode_line(NULL, &c->in)) == NULL)
+        {
+            conn_printf(srv, c, L"\n\tEntrada inválida!\n\nNome do jogador: ");
+            return;
+        }
+
+        if (wstr_size(text) < 1 || wstr_size(text) > srv->config->name_size)
+        {
+            free(text);
+            conn_printf(srv, c, L"\n\tNome deve ter entre 1 e %d caracteres!\n\nNome do jogador: ", srv->config->name_size);
+            return;
+        }
+
+        c->name = text;
+        room_join(srv, c);
+        return;
+
+    case CONN_WAITING:
+        conn_printf(srv, c, L"\nAguardando jogadores (%d/%d)...\n", r->seated, srv->humans_per_room);
+        return;
+
+    case CONN_PLAYING:
+        data = &r->data;
+
+        if (!room_awaits(r, c->seat))
+            conn_printf(srv, c, (r->state == ROOM_COLLECT)? L"\nAguarde o fim da rodada.\n": L"\nAguarde sua vez.\n");
+        else if ((answer = str8_new(&data->round_arena, c->in.line, c->in.len)) == NULL)
+        { /* a resposta segue em UTF-8, como chegou */
+            conn_printf(srv, c, L"\n\tEntrada inválida!\n");
+            room_prompt(srv, r, c->seat);
+        }
+        else
+            room_answer(srv, r, c, answer);
+        return;
+    }
+}
+
+static int line_limit(server *srv, connection *c)
+{ /* caracteres guardados por linha: o bastante para detectar o excesso */
+    if (c->state == CONN_NAMING)
+        return srv->config->name_size;
+
+    return (c->room != NULL)? c->room->data.answer_size: READER_LINE;
+}
+
+static void handle_readable(server *srv, connection *c)
+{
+    ssize_t n;
+
+    for (int reads = 0; reads < READS_PER_EVENT; reads++)
+    {
+        n = reader_fill(&c->in);
+
+        if (n == 0 || (n == -1 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            conn_kill(srv, c);
+            return;
+        }
+
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        while (reader_next(&c->in, line_limit(srv, c)))
+        {
+            handle_line(srv, c);
+
+            if (c->doomed)
+                return;
+        }
+    }
+}
+
+static void room_timeout(server *srv, room *r)
+{
+    game_data *data = &r->data;
+    str8 *answer;
+    int player;
+
+    switch (r->state)
+    {
+    case ROOM_TURN:
+        player = data->players_sequence[data->curr_turn];
+
+        if (r->bot_answer != NULL)
+        {
+            answer = r->bot_answer;
+            r->bot_answer = NULL;
+            room_printf(srv, r, L"\n%S respondeu.\n", player_name(data, player));
+            room_end_turn(srv, r, answer, timer_now() - r->turn_start);
+            break;
+        }
+
+        if (r->seat[player] != NULL)
+            conn_printf(srv, r->seat[player], L"\n\n\tTempo esgotado!\n");
+
+        room_end_turn(srv, r, data->no_answer, seconds_to_ns(player_total_time(data)));
+        break;
+
+    case ROOM_COLLECT: /* prazo da rodada: quem não respondeu fica sem resposta */
+        for (player = 0; player < data->number_of_players; player++)
+        {
+            if (data->round_answer[player] != NULL)
+                continue;
+
+            if (r->seat[player] != NULL)
+                conn_printf(srv, r->seat[player], L"\n\n\tTempo esgotado!\n");
+
+            data->round_answer[player] = data->no_answer;
+            charge_turn(data, player, data->curr_time_left - r->turn_start);
+        }
+
+        r->pending = 0;
+        room_end_round(srv, r);
+        break;
+
+    case ROOM_INTERMISSION:
+        data->curr_round++;
+        room_begin_round(srv, r);
+        break;
+
+    case ROOM_FILLING:
+        break;
+    }
+}
+
+static void handle_timers(server *srv)
+{ /* um disparo atende todas as salas cujo prazo venceu */
+    timer_entry *e;
+    nsec now;
+
+    timer_acknowledge(&srv->timers);
+    now = timer_now();
+
+    while ((e = timer_expired(&srv->timers, now)) != NULL)
+    {
+        if (e == &srv->flush_tick)
+        {
+            if (srv->journal != NULL && journal_flush(srv->journal) == -1)
+                fwprintf(stderr, L"Falha ao gravar o diário (errno == %d).\n", errno);
+            if (srv->leaderboard != NULL)
+                leaderboard_flush(srv->leaderboard);
+            if (srv->options->stats_path != NULL)
+                probe_write(srv->options->stats_path);
+
+            timer_set(&srv->timers, e, now + FLUSH_INTERVAL * NSEC_PER_SEC);
+        }
+        else
+            room_timeout(srv, (room *)e);
+    }
+}
+
+static void handle_linger(server *srv)
+{ /* conexões encerradas cujo cliente não fechou a tempo */
+    timer_entry *e;
+    nsec now;
+
+    timer_acknowledge(&srv->lingering);
+    now = timer_now();
+
+    while ((e = timer_expired(&srv->lingering, now)) != NULL)
+        conn_kill(srv, (connection *)((char *)e - offsetof(connection, linger)));
+}
+
+static void handle_reload(server *srv)
+{ /* SIGHUP: carrega o pacote de novo; em caso de erro, mantém o atual */
+    game_config *config;
+    int error_line;
+
+    if ((config = config_load(srv->options->config_path, srv->options->dict_path, &error_line)) == NULL)
+    {
+        if (error_line > 0)
+            fwprintf(stderr, L"Pacote mantido: linha %d inválida em <%s>.\n", error_line, srv->options->config_path);
+        else
+            fwprintf(stderr, L"Pacote mantido: falha ao recarregar (errno == %d).\n", errno);
+        return;
+    }
+
+    config_release(srv->config);
+    srv->config = config;
+
+    if (srv->filling != NULL)
+    { /* a sala em formação ainda não começou: passa a usar o pacote novo */
+        config_release(srv->filling->data.config);
+        room_bind(srv, srv->filling);
+    }
+
+    wprintf(L"Pacote recarregado: %d categoria(s), %d letra(s), %d rodada(s).\n",
+            config->number_of_categories, config->number_of_letters, config->rounds);
+    fflush(stdout);
+}
+
+static void handle_signals(server *srv)
+{ /* sinais repetidos antes da leitura contam uma vez só */
+    struct signalfd_siginfo info;
+    int reload = 0, report = 0;
+
+    while (read(srv->signals.fd, &info, sizeof(info)) == sizeof(info))
+    {
+        if (info.ssi_signo == SIGHUP)
+            reload = 1;
+        else if (info.ssi_signo == SIGUSR1)
+            report = 1;
+    }
+
+    if (reload)
+        handle_reload(srv);
+
+    if (report && srv->options->stats_path != NULL && probe_write(srv->options->stats_path) == -1)
+        fwprintf(stderr, L"Falha ao gravar as medidas em <%s> (errno == %d).\n", srv->options->stats_path, errno);
+}
+
+static void handle_accept(server *srv)
+{
+    struct epoll_event ev;
+    connection *c;
+    int fd, one = 1;
+
+    while ((fd = accept4(srv->listener.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1)
+    {
+        c = calloc(1, sizeof(connection));
+
+        if (c == NULL)
+        {
+            close(fd);
+            continue;
+        }
+
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        c->source.type = SOURCE_CONNECTION;
+        c->source.fd = fd;
+        reader_init(&c->in, fd);
+        timer_entry_init(&c->linger);
+        c->state = CONN_NAMING;
+
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = &c->source;
+
+        if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        {
+            close(fd);
+            free(c);
+            continue;
+        }
+
+        conn_printf(srv, c, L"Bem-vindo ao Scattergory!\n\nNome do jogador: ");
+    }
+}
+
+static void collect_garbage(server *srv)
+{ /* fecha e libera o que foi descartado durante o lote de eventos já processado */
+    connection *c;
+    room *r;
+
+    while ((c = srv->doomed_connections) != NULL)
+    {
+        srv->doomed_connections = c->next_doomed;
+        conn_drop(srv, c); /* pode condenar outras conexões da mesma sala */
+    }
+
+    while ((c = srv->dead_connections) != NULL)
+    {
+        srv->dead_connections = c->next_dead;
+        free(c->name);
+        free(c->out);
+        free(c);
+    }
+
+    while ((r = srv->dead_rooms) != NULL)
+    {
+        srv->dead_rooms = r->next_dead;
+        free(r->seat);
+        free(r);
+    }
+}
+
+static int open_listener(int port)
+{
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0), one = 1;
+
+    if (fd == -1)
+        return -1;
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, SOMAXCONN) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void raise_fd_limit(void)
+{ /* cada jogador usa um socket; as salas compartilham um único timer */
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static int open_signals(void)
+{ /* SIGHUP e SIGUSR1 deixam de ser entregues ao processo e passam a ser lidos do descritor */
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGHUP);
+    sigaddset(&mask, SIGUSR1);
+
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) == -1)
+        return -1;
+
+    return signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+int server_run(const server_options *options, game_config *config, journal *log, leaderboard *ranking)
+{
+    int port = options->port, players_per_room = options->players_per_room;
+    server srv;
+    struct epoll_event ev, events[MAX_EVENTS];
+    event_source *source;
+    int n;
+
+    if (port <= 0 || port > 65535 || players_per_room < 2 || players_per_room > MAX_PLAYERS || options->bots < 0 || options->bots >= players_per_room)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    raise_fd_limit();
+
+    memset(&srv, 0, sizeof(srv));
+    srv.options = options;
+    srv.humans_per_room = players_per_room - options->bots;
+    srv.config = config;
+    srv.sink = fopen("/dev/null", "w");
+    srv.journal = log;
+    srv.leaderboard = ranking;
+    srv.listener.type = SOURCE_LISTENER;
+    srv.listener.fd = open_listener(port);
+    srv.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (srv.listener.fd == -1 || srv.epoll_fd == -1 || srv.sink == NULL || timer_queue_init(&srv.timers) == -1 || timer_queue_init(&srv.lingering) == -1)
+        return -1;
+
+    srv.clock.type = SOURCE_TIMER;
+    srv.clock.fd = srv.timers.fd;
+    srv.linger_clock.type = SOURCE_TIMER;
+    srv.linger_clock.fd = srv.lingering.fd;
+    srv.signals.type = SOURCE_SIGNAL;
+
+    if ((srv.signals.fd = open_signals()) == -1)
+        return -1;
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = &srv.listener;
+
+    if (epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.listener.fd, &ev) == -1)
+        return -1;
+
+    ev.data.ptr = &srv.clock;
+
+    if (epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.clock.fd, &ev) == -1)
+        return -1;
+
+    ev.data.ptr = &srv.linger_clock;
+
+    if (epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.linger_clock.fd, &ev) == -1)
+        return -1;
+
+    ev.data.ptr = &srv.signals;
+
+    if (epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.signals.fd, &ev) == -1)
+        return -1;
+
+    timer_entry_init(&srv.flush_tick);
+
+    if ((log != NULL || ranking != NULL || options->stats_path != NULL) && timer_set(&srv.timers, &srv.flush_tick, timer_now() + FLUSH_INTERVAL * NSEC_PER_SEC) == -1)
+        return -1;
+
+    wprintf(L"Servidor escutando na porta %d (%d jogadores por sala, %d deles robôs%S); SIGHUP recarrega o pacote.\n",
+            port, players_per_room, options->bots, options->simultaneous? L", respostas simultâneas": L"");
+
+    if (options->stats_path != NULL)
+        wprintf(L"Medidas gravadas em <%s> a cada %d segundo(s) e ao receber SIGUSR1.\n", options->stats_path, FLUSH_INTERVAL);
+
+    fflush(stdout);
+
+    for (;;)
+    {
+        n = epoll_wait(srv.epoll_fd, events, MAX_EVENTS, -1);
+
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            source = events[i].data.ptr;
+
+            if (source->fd == -1 || (source->type == SOURCE_CONNECTION && ((connection *)source)->doomed))
+                continue;
+
+            switch (source->type)
+            {
+            case SOURCE_LISTENER:
+                handle_accept(&srv);
+                break;
+
+            case SOURCE_TIMER:
+                if (source == &srv.clock)
+                    handle_timers(&srv);
+                else
+                    handle_linger(&srv);
+                break;
+
+            case SOURCE_SIGNAL:
+                handle_signals(&srv);
+                break;
+
+            case SOURCE_CONNECTION:
+                if (events[i].events & EPOLLOUT)
+                    conn_flush(&srv, (connection *)source);
+
+                if (source->fd != -1 && events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                    handle_readable(&srv, (connection *)source);
+                break;
+            }
+        }
+
+        collect_garbage(&srv);
+    }
+}
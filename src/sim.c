@@ -0,0 +1,596 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <main.h>
+#include <sim.h>
+#include <pool.h>
+
+#define MAX_ATTEMPTS 3 /* respostas recusadas antes de o tempo se esgotar */
+
+enum { PHASE_SETUP, PHASE_TURNS, PHASE_SCORING, PHASE_TABLES, PHASE_FINISH, PHASES };
+
+static const wchar_t *const phase_name[PHASES] = {L"preparo", L"turnos", L"pontuação", L"tabelas", L"encerramento"};
+static const wchar_t *const phase_unit[PHASES] = {L"partida", L"turno", L"rodada", L"rodada", L"partida"};
+
+typedef struct {
+    wchar_t **line;
+    int lines;
+    int next; /* próxima resposta, compartilhada por todos os jogadores */
+} script;
+
+typedef struct {
+    double phase[PHASES]; /* segundos */
+    long long games, rounds, turns, attempts, rejected, timeouts;
+    long long checksum;   /* totais e vencedores, para comparar execuções */
+
+    /* equilíbrio do pacote: por posição (ou faixa, ver <slot()>) na ordem da rodada e por categoria */
+    long long slot_turns[SIM_SLOTS], slot_points[SIM_SLOTS], slot_timeouts[SIM_SLOTS];
+    long long category_rounds[CONFIG_CATEGORIES], category_points[CONFIG_CATEGORIES], category_hits[CONFIG_CATEGORIES];
+} sim_stats;
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static int load_script(script *s, const char *path)
+{ /* linhas vazias são ignoradas */
+    FILE *f = fopen(path, "r");
+    wchar_t *line, **grown;
+    int cap = 0;
+
+    if (f == NULL)
+        return -1;
+
+    while ((line = read_line(NULL, f)) != NULL)
+    {
+        if (line[0] == 0)
+        {
+            free(line);
+
+            if (feof(f) || ferror(f))
+                break;
+
+            continue;
+        }
+
+        if (s->lines == cap)
+        {
+            cap = cap? 2 * cap: 64;
+
+            if ((grown = realloc(s->line, cap * sizeof(wchar_t *))) == NULL)
+            {
+                free(line);
+                fclose(f);
+                return -1;
+            }
+
+            s->line = grown;
+        }
+
+        s->line[s->lines++] = line;
+    }
+
+    fclose(f);
+
+    if (s->lines == 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void free_script(script *s)
+{
+    for (int i = 0; i < s->lines; i++)
+        free(s->line[i]);
+
+    free(s->line);
+}
+
+static wchar_t **make_names(int players)
+{ /* "Jogador 01", ...: ponteiros seguidos dos textos, num só bloco */
+    wchar_t **names = malloc(players * (sizeof(wchar_t *) + 16 * sizeof(wchar_t)));
+    wchar_t *text = (wchar_t *)(names + players);
+
+    for (int p = 0; names != NULL && p < players; p++, text += 16)
+    {
+        swprintf(text, 16, L"Jogador %02d", p + 1);
+        names[p] = text;
+    }
+
+    return names;
+}
+
+static int slot(const game_data *data, int turn)
+{ /* a própria posição ou, com mais de SIM_SLOTS jogadores, sua faixa */
+    if (data->number_of_players <= SIM_SLOTS)
+        return turn;
+
+    return (long long)turn * SIM_SLOTS / data->number_of_players;
+}
+
+static wchar_t *script_answer(game_data *data, script *s, wchar_t letter)
+{ /* um '*' inicial é trocado pela letra da rodada */
+    wchar_t *line = s->line[s->next++ % s->lines];
+
+    if (line[0] == L'*')
+        return fwstring(&data->round_arena, L"%C%S", letter, line + 1);
+
+    return trim_wstring(&data->round_arena, line);
+}
+
+static wchar_t *random_answer(game_data *data, wchar_t letter)
+{ /* palavra inventada; às vezes repetida entre jogadores, às vezes com a letra errada */
+    static const wchar_t tail[] = L"abcdefghijlmnopqrstuvxzáãçéêíóõú";
+    static const wchar_t *const common[] = {L"ana", L"ão", L"eira", L"inho"};
+    wchar_t word[16];
+    double dice = rng_unit(&data->rng);
+    int n, i;
+
+    if (dice < .1)
+        letter = data->letters[rng_range(&data->rng, 0, data->number_of_letters)];
+
+    if (dice < .4)
+        return fwstring(&data->round_arena, L"%C%S", letter, common[rng_range(&data->rng, 0, 4)]);
+
+    n = rng_range(&data->rng, 2, 12);
+
+    for (i = 0; i < n; i++)
+        word[i] = tail[rng_range(&data->rng, 0, sizeof(tail) / sizeof(wchar_t) - 1)];
+
+    word[n] = 0;
+
+    if (dice > .95)
+        return fwstring(&data->round_arena, L"%C%S da Silva", letter, word);
+
+    return fwstring(&data->round_arena, L"%C%S", letter, word);
+}
+
+static str8 *typed_turn(game_data *data, script *s, FILE *sink, sim_stats *stats, double total, double *used)
+{ /* roteiro ou palavras inventadas: até MAX_ATTEMPTS respostas, enquanto houver tempo */
+    wchar_t letter = data->letters[data->letters_sequence[data->curr_round]];
+    wchar_t *typed;
+    str8 *answer;
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+    {
+        *used += total * (.1 + .6 * rng_unit(&data->rng)); /* pensar e digitar */
+
+        if (*used >= total)
+            break;
+
+        typed = (s->lines > 0)? script_answer(data, s, letter): random_answer(data, letter);
+        stats->attempts++;
+
+        if (typed != NULL && validate_answer(sink, &data->round_arena, typed, 1, data->answer_size))
+        { /* guardada em UTF-8, como no servidor */
+            if ((answer = str8_from_wide(&data->round_arena, typed)) != NULL && check_answer(sink, data, answer))
+                return answer;
+
+            arena_pop(&data->round_arena, answer);
+        }
+
+        stats->rejected++;
+    }
+
+    return NULL;
+}
+
+static void play_turn(game_data *data, script *s, FILE *sink, sim_stats *stats)
+{ /* com dicionário, robô (os <bots> últimos assentos, ou todos sem roteiro); sem ele, roteiro ou palavras inventadas */
+    int player = data->players_sequence[data->curr_turn];
+    double total = player_total_time(data), used = 0;
+    str8 *answer;
+
+    if (is_bot(data, player) || (s->lines == 0 && data->config->bots != NULL))
+    { /* decide de uma vez e, sem resposta, deixa o tempo se esgotar */
+        answer = bot_turn(sink, data, total, &used);
+        stats->attempts++;
+    }
+    else
+        answer = typed_turn(data, s, sink, stats, total, &used);
+
+    if (answer == NULL)
+    {
+        stats->timeouts++;
+        stats->slot_timeouts[slot(data, data->curr_turn)]++;
+        used = total;
+        answer = data->no_answer;
+    }
+
+    data->round_answer[player] = answer;
+    charge_turn(data, player, seconds_to_ns(used));
+    stats->turns++;
+}
+
+static void tally_balance(game_data *data, sim_stats *stats)
+{ /* pontos da rodada por posição na ordem (a primeira tem mais tempo) e por categoria */
+    int r = data->curr_round, cat = data->categories_sequence[r], points;
+
+    for (int t = 0; t < data->number_of_players; t++)
+    {
+        points = player_scores(data, data->players_sequence[t])[r];
+        stats->slot_turns[slot(data, t)]++;
+        stats->slot_points[slot(data, t)] += points;
+        stats->category_points[cat] += points;
+        stats->category_hits[cat] += (points > 0);
+    }
+
+    stats->category_rounds[cat] += data->number_of_players;
+}
+
+static int play_game(const sim_options *options, game_config *config, uint64_t seed, wchar_t *const *names, journal *log, leaderboard *ranking, script *s, FILE *sink, sim_stats *stats)
+{
+    game_data data = new_game(config);
+    double start = now(), end;
+    int p, winner;
+
+    data.journal = log;
+    data.leaderboard = ranking;
+    data.number_of_players = options->players;
+    data.bots = options->bots;
+    data.bot_profile = &options->bot;
+    data.seed = seed;
+
+    if (init_game(&data, names) == -1)
+    {
+        free_game(&data);
+        return -1;
+    }
+
+    stats->phase[PHASE_SETUP] += (end = now()) - start;
+
+    for (data.curr_round = 0; data.curr_round < data.rounds; data.curr_round++)
+    {
+        start = end;
+
+        draw_turn_order(&data);
+
+        for (data.curr_turn = 0; data.curr_turn < data.number_of_players; data.curr_turn++)
+            play_turn(&data, s, sink, stats);
+
+        stats->phase[PHASE_TURNS] += (end = now()) - start;
+        start = end;
+
+        if (score_round(&data) == -1 || (data.journal != NULL && journal_round(data.journal, &data) == -1))
+        {
+            free_game(&data);
+            return -1;
+        }
+
+        tally_balance(&data, stats);
+
+        stats->phase[PHASE_SCORING] += (end = now()) - start;
+        start = end;
+
+        show_answers(sink, &data); /* formatada como no terminal, mas descartada */
+        arena_reset(&data.round_arena);
+        show_scores(sink, &data);
+
+        stats->phase[PHASE_TABLES] += (end = now()) - start;
+
+        stats->rounds++;
+    }
+
+    start = end;
+
+    data.curr_round--;
+    winner = victor(&data);
+
+    if (ranking != NULL && leaderboard_game(ranking, &data, winner) == -1)
+    {
+        free_game(&data);
+        return -1;
+    }
+
+    stats->checksum += winner;
+
+    for (p = 0; p < data.number_of_players; p++)
+        stats->checksum += data.total[p];
+
+    free_game(&data);
+
+    stats->phase[PHASE_FINISH] += now() - start;
+    stats->games++;
+
+    return 0;
+}
+
+static void report_players(const sim_options *options, const game_config *config)
+{ /* quem ocupou os assentos: só com robôs do dicionário o equilíbrio do pacote diz algo */
+    if (config->bots == NULL)
+        wprintf(L"Jogadores: %S, sem dicionário (pontos e equilíbrio do pacote não são significativos)\n\n",
+                (options->script != NULL)? L"roteiro": L"palavras inventadas");
+    else if (options->script != NULL)
+        wprintf(L"Jogadores: roteiro, com %d robô(s) do dicionário (habilidade %.0lf%%)\n\n", options->bots, 100 * options->bot.skill);
+    else
+        wprintf(L"Jogadores: robôs do dicionário (habilidade %.0lf%%)\n\n", 100 * options->bot.skill);
+}
+
+static void report(const sim_options *options, const game_config *config, const sim_stats *stats, double elapsed)
+{
+    const long long count[PHASES] = {stats->games, stats->turns, stats->rounds, stats->rounds, stats->games};
+
+    wprintf(L"Simulação: %d partida(s) de %d jogadores, semente %llu\n\n", options->games, options->players, (unsigned long long)options->seed);
+    report_players(options, config);
+    wprintf(L"Tempo total:  %.3lf s\n", elapsed);
+    wprintf(L"Partidas/s:   %.1lf\n", stats->games / elapsed);
+    wprintf(L"Turnos/s:     %.1lf\n\n", stats->turns / elapsed);
+    wprintf(L"Turnos: %lld, respostas: %lld, recusadas: %lld, tempo esgotado: %lld\n\n",
+            stats->turns, stats->attempts, stats->rejected, stats->timeouts);
+
+    for (int i = 0; i < PHASES; i++)
+        wprintf(L"  %-12S %10.3lf ms %12.0lf ns/%S\n", phase_name[i], stats->phase[i] * 1E3,
+                count[i]? stats->phase[i] * 1E9 / count[i]: 0., phase_unit[i]);
+
+    wprintf(L"\nVerificação: %lld\n", stats->checksum);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Roda a simulação descrita por <options> com o pacote <config> (e seu
+ *  dicionário, se houver), registrando as rodadas em <log> e acumulando
+ *  as partidas em <ranking> (ambos podem ser NULL), e imprime o relatório
+ *  na saída padrão.
+ *
+ *  - RETORNO:
+ *
+ *  0 em caso de sucesso e -1 em caso de erro (ver <errno>).
+ */
+
+int sim_run(const sim_options *options, game_config *config, journal *log, leaderboard *ranking)
+{
+    script s = {NULL, 0, 0};
+    sim_stats stats = {{0}};
+    wchar_t **names;
+    FILE *sink;
+    double start;
+    int status = 0;
+
+    if (options->games <= 0 || options->players < 2 || options->players > MAX_PLAYERS || options->bots < 0 || options->bots >= options->players ||
+        (options->bots > 0 && config->bots == NULL))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (options->script != NULL && load_script(&s, options->script) == -1)
+    {
+        free_script(&s);
+        return -1;
+    }
+
+    if ((names = make_names(options->players)) == NULL || (sink = fopen("/dev/null", "w")) == NULL)
+    {
+        free(names);
+        free_script(&s);
+        return -1;
+    }
+
+    start = now();
+
+    for (int g = 0; status == 0 && g < options->games; g++)
+        status = play_game(options, config, rng_mix(options->seed, g), names, log, ranking, &s, sink, &stats);
+
+    if (status == 0)
+        report(options, config, &stats, now() - start);
+
+    fclose(sink);
+    free(names);
+    free_script(&s);
+
+    return status;
+}
+
+/* ------------------------------------------------------------------ */
+/* torneio                                                             */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    sim_stats stats;
+    script s;   /* linhas compartilhadas; só o cursor é desta thread */
+    FILE *sink;
+    int error;  /* <errno> da primeira partida que falhou, ou 0 */
+} __attribute__((aligned(64))) worker_state;
+
+typedef struct {
+    const sim_options *options;
+    game_config *config;
+    wchar_t **names; /* dos jogadores, compartilhados por todas as partidas */
+    worker_state *worker;
+} tournament;
+
+static void tournament_game(long game, int id, void *context)
+{
+    tournament *t = context;
+    worker_state *w = &t->worker[id];
+
+    if (w->error != 0)
+        return;
+
+    if (w->s.lines > 0)
+        w->s.next = (game * t->options->players * t->config->rounds) % w->s.lines;
+
+    if (play_game(t->options, t->config, rng_mix(t->options->seed, game), t->names, NULL, NULL, &w->s, w->sink, &w->stats) == -1)
+        w->error = errno? errno: ENOMEM;
+}
+
+static void merge_stats(sim_stats *into, const sim_stats *from)
+{
+    for (int i = 0; i < PHASES; i++)
+        into->phase[i] += from->phase[i];
+
+    into->games += from->games;
+    into->rounds += from->rounds;
+    into->turns += from->turns;
+    into->attempts += from->attempts;
+    into->rejected += from->rejected;
+    into->timeouts += from->timeouts;
+    into->checksum += from->checksum;
+
+    for (int i = 0; i < SIM_SLOTS; i++)
+    {
+        into->slot_turns[i] += from->slot_turns[i];
+        into->slot_points[i] += from->slot_points[i];
+        into->slot_timeouts[i] += from->slot_timeouts[i];
+    }
+
+    for (int i = 0; i < CONFIG_CATEGORIES; i++)
+    {
+        into->category_rounds[i] += from->category_rounds[i];
+        into->category_points[i] += from->category_points[i];
+        into->category_hits[i] += from->category_hits[i];
+    }
+}
+
+static void report_tournament(const sim_options *options, const game_config *config, const tournament *t, int threads, const sim_stats *stats, double elapsed)
+{
+    const long long count[PHASES] = {stats->games, stats->turns, stats->rounds, stats->rounds, stats->games};
+    double turns;
+
+    wprintf(L"Torneio: %d partida(s) de %d jogadores, semente %llu, %d thread(s)\n\n", options->games, options->players, (unsigned long long)options->seed, threads);
+    report_players(options, config);
+    wprintf(L"Tempo total:  %.3lf s\n", elapsed);
+    wprintf(L"Partidas/s:   %.1lf\n", stats->games / elapsed);
+    wprintf(L"Turnos/s:     %.1lf\n\n", stats->turns / elapsed);
+
+    wprintf(L"Partidas por thread:");
+
+    for (int i = 0; i < threads; i++)
+        wprintf(L" %lld", t->worker[i].stats.games);
+
+    wprintf(L"\n\nTurnos: %lld, respostas: %lld, recusadas: %lld, tempo esgotado: %lld\n\n",
+            stats->turns, stats->attempts, stats->rejected, stats->timeouts);
+
+    for (int i = 0; i < PHASES; i++) /* somado entre as threads */
+        wprintf(L"  %-12S %10.3lf ms %12.0lf ns/%S\n", phase_name[i], stats->phase[i] * 1E3,
+                count[i]? stats->phase[i] * 1E9 / count[i]: 0., phase_unit[i]);
+
+    wprintf(L"\nPosição na rodada   pontos/turno   tempo esgotado\n");
+
+    for (int i = 0, first, last; i < SIM_SLOTS && i < options->players; i++)
+    {
+        turns = stats->slot_turns[i]? stats->slot_turns[i]: 1;
+
+        if (options->players <= SIM_SLOTS)
+            wprintf(L"  %2dª              ", i + 1);
+        else
+        { /* faixa: posições cuja <slot()> é <i> */
+            first = ((long long)i * options->players + SIM_SLOTS - 1) / SIM_SLOTS;
+            last = ((long long)(i + 1) * options->players + SIM_SLOTS - 1) / SIM_SLOTS - 1;
+            wprintf(L"  %5dª a %5dª    ", first + 1, last + 1);
+        }
+
+        wprintf(L"  %8.3lf      %8.2lf%%\n", stats->slot_points[i] / turns, 100. * stats->slot_timeouts[i] / turns);
+    }
+
+    wprintf(L"\nCategoria       pontos/turno   com pontos\n");
+
+    for (int c = 0; c < config->number_of_categories; c++)
+        if (stats->category_rounds[c] > 0)
+            wprintf(L"  %-*S %8.3lf      %8.2lf%%\n", config->category_width > 12? config->category_width: 12, config->categories[c],
+                    stats->category_points[c] / (double)stats->category_rounds[c],
+                    100. * stats->category_hits[c] / stats->category_rounds[c]);
+
+    wprintf(L"\nVerificação: %lld\n", stats->checksum);
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Joga as partidas de <options> em paralelo, em <options->threads>
+ *  threads com roubo de trabalho (ver <pool.h>), com o pacote <config>,
+ *  sem diário nem ranking: cada thread tem seus jogadores simulados e seu
+ *  acumulador, somados ao final. Cada partida tem seu gerador, semeado
+ *  como em <sim_run()> a partir de <options->seed> e do seu número, de
+ *  modo que o resultado não depende do número de threads. Imprime o
+ *  relatório, com o equilíbrio do pacote, na saída padrão.
+ *
+ *  - RETORNO:
+ *
+ *  0 em caso de sucesso e -1 em caso de erro (ver <errno>).
+ */
+
+int sim_tournament(const sim_options *options, game_config *config)
+{
+    script s = {NULL, 0, 0};
+    sim_stats stats = {{0}};
+    tournament t = {options, config, NULL, NULL};
+    int threads = options->threads, w, status = 0;
+    double start;
+
+    if (options->games <= 0 || options->players < 2 || options->players > MAX_PLAYERS || options->bots < 0 || options->bots >= options->players ||
+        (options->bots > 0 && config->bots == NULL) || threads < 1)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (threads > options->games)
+        threads = options->games;
+
+    if (options->script != NULL && load_script(&s, options->script) == -1)
+    {
+        free_script(&s);
+        return -1;
+    }
+
+    if ((t.names = make_names(options->players)) == NULL || posix_memalign((void **)&t.worker, 64, threads * sizeof(worker_state)) != 0)
+    {
+        errno = ENOMEM;
+        free(t.names);
+        free_script(&s);
+        return -1;
+    }
+
+    for (w = 0; w < threads; w++)
+    {
+        memset(&t.worker[w], 0, sizeof(worker_state));
+        t.worker[w].s = s;
+
+        if ((t.worker[w].sink = fopen("/dev/null", "w")) == NULL)
+            break;
+    }
+
+    if (w < threads)
+        status = -1;
+    else
+    {
+        start = now();
+        status = pool_run(threads, options->games, tournament_game, &t);
+
+        for (w = 0; status == 0 && w < threads; w++)
+        {
+            merge_stats(&stats, &t.worker[w].stats);
+
+            if (t.worker[w].error != 0)
+            {
+                errno = t.worker[w].error;
+                status = -1;
+            }
+        }
+
+        if (status == 0)
+            report_tournament(options, config, &t, threads, &stats, now() - start);
+    }
+
+    for (w = 0; w < threads && t.worker[w].sink != NULL; w++)
+        fclose(t.worker[w].sink);
+
+    free(t.worker);
+    free(t.names);
+    free_script(&s);
+
+    return status;
+}
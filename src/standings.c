@@ -0,0 +1,58 @@
+#include <stdlib.h>
+#include <string.h>
+#include <standings.h>
+
+static int ahead(const void *keys, int a, int b)
+{ /* <a> vem antes de <b> na classificação */
+    const int *total = keys;
+
+    if (total[a] != total[b])
+        return total[a] > total[b];
+
+    return a < b;
+}
+
+int standings_init(standings *s, int players)
+{ /* todos empatados em zero, na ordem dos assentos; nós e totais num só bloco */
+    treap_node *node = calloc(players, sizeof(treap_node) + sizeof(int));
+
+    if (node == NULL)
+        return -1;
+
+    s->players = players;
+    s->total = (int *)(node + players);
+
+    treap_init(&s->order, node, ahead, s->total);
+
+    for (int p = 0; p < players; p++)
+        treap_insert(&s->order, p);
+
+    return 0;
+}
+
+void standings_update(standings *s, int player, int total)
+{
+    if (s->total[player] == total)
+        return;
+
+    treap_erase(&s->order, player);
+    s->total[player] = total;
+    treap_insert(&s->order, player);
+}
+
+int standings_position(const standings *s, int player)
+{ /* posição de <player>, a partir de 1 */
+    return treap_rank(&s->order, player);
+}
+
+int standings_top(const standings *s, int k, int *out)
+{ /* os <k> primeiros em <out>, em ordem; retorna quantos são */
+    return treap_top(&s->order, k, out);
+}
+
+void standings_free(standings *s)
+{
+    free(s->order.node);
+
+    memset(s, 0, sizeof(standings));
+}
@@ -0,0 +1,168 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <wstr.h>
+#include <str8.h>
+
+static int utf8_extra(unsigned char lead)
+{ /* bytes de continuação após <lead>; -1 se não puder iniciar caractere */
+    if (lead < 0x80)
+        return 0;
+    if (lead < 0xC2) /* continuação solta ou forma longa de ASCII */
+        return -1;
+    if (lead < 0xE0)
+        return 1;
+    if (lead < 0xF0)
+        return 2;
+    if (lead < 0xF5)
+        return 3;
+    return -1;
+}
+
+static int utf8_second(unsigned char lead, unsigned char second)
+{ /* o segundo byte, conforme <lead>: recusa formas longas, surrogates e o que passa de U+10FFFF */
+    switch (lead)
+    {
+    case 0xE0:
+        return second >= 0xA0 && second <= 0xBF;
+    case 0xED:
+        return second >= 0x80 && second <= 0x9F;
+    case 0xF0:
+        return second >= 0x90 && second <= 0xBF;
+    case 0xF4:
+        return second >= 0x80 && second <= 0x8F;
+    default:
+        return (second & 0xC0) == 0x80;
+    }
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Cria string a partir dos <n> bytes UTF-8 de <bytes>, aparando espaços
+ *  extremos e colapsando os internos contíguos, como <trim_wstring()>.
+ *
+ *  - RETORNO:
+ *
+ *  a nova string, ou NULL se <bytes> não for UTF-8 válido (EILSEQ) ou se
+ *  faltar memória.
+ */
+
+str8 *str8_new(arena *a, const char *bytes, int n)
+{
+    const unsigned char *src = (const unsigned char *)bytes;
+    str8 *s = mem_alloc(a, sizeof(str8) + n + 1);
+    int i = 0, j = 0, length = 0, extra, pending_space = 0;
+
+    if (s == NULL)
+        return NULL;
+
+    while (i < n && src[i] == ' ')
+        i++;
+
+    while (i < n)
+    {
+        if (src[i] == ' ')
+        { /* só é escrito se vier algo depois */
+            pending_space = 1;
+            i++;
+            continue;
+        }
+
+        if (src[i] == '\0' || (extra = utf8_extra(src[i])) == -1 || i + extra >= n)
+            goto invalid;
+
+        if (extra > 0 && !utf8_second(src[i], src[i + 1]))
+            goto invalid;
+
+        for (int k = 2; k <= extra; k++)
+            if ((src[i + k] & 0xC0) != 0x80)
+                goto invalid;
+
+        if (pending_space)
+        {
+            s->bytes[j++] = ' ';
+            length++;
+            pending_space = 0;
+        }
+
+        memcpy(s->bytes + j, src + i, extra + 1);
+        i += extra + 1;
+        j += extra + 1;
+        length++;
+    }
+
+    s->bytes[j] = '\0';
+    s->size = j;
+    s->length = length;
+
+    return s;
+
+invalid:
+    mem_free(a, s);
+    errno = EILSEQ;
+    return NULL;
+}
+
+str8 *str8_from_wide(arena *a, const wchar_t *w)
+{
+    char buffer[4];
+    int size = 0, length;
+    str8 *s;
+
+    for (length = 0; w[length] != 0; length++)
+    {
+        if (w[length] < 0 || w[length] > 0x10FFFF)
+        {
+            errno = EILSEQ;
+            return NULL;
+        }
+
+        size += utf8_put(buffer, w[length]);
+    }
+
+    if ((s = mem_alloc(a, sizeof(str8) + size + 1)) == NULL)
+        return NULL;
+
+    s->size = size;
+    s->length = length;
+
+    for (int i = 0, j = 0; i < length; i++)
+        j += utf8_put(s->bytes + j, w[i]);
+
+    s->bytes[size] = '\0';
+
+    return s;
+}
+
+void str8_decode(const str8 *s, wchar_t *dst)
+{ /* <dst> deve ter <s->length> + 1 posições */
+    const char *p = s->bytes;
+
+    for (int i = 0; i < s->length; i++)
+        dst[i] = utf8_next(&p);
+
+    dst[s->length] = 0;
+}
+
+int str8_starts_with(const str8 *s, wchar_t folded)
+{ /* <folded> já passada por <fold_char()>, como em <game_config.folded_letters>: só a inicial é dobrada */
+    const char *p = s->bytes;
+
+    return s->size > 0 && fold_char(utf8_next(&p)) == folded;
+}
+
+void str8_first_word(str8 *s)
+{ /* trunca <s> no primeiro espaço */
+    char *space = memchr(s->bytes, ' ', s->size);
+
+    if (space == NULL)
+        return;
+
+    *space = '\0';
+    s->size = space - s->bytes;
+    s->length = 0;
+
+    for (int i = 0; i < s->size; i++)
+        s->length += ((s->bytes[i] & 0xC0) != 0x80);
+}
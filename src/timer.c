@@ -0,0 +1,223 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <timer.h>
+
+nsec timer_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+nsec seconds_to_ns(double sec)
+{
+    return (nsec)(sec * NSEC_PER_SEC + .5);
+}
+
+double ns_to_seconds(nsec ns)
+{
+    return ns / (double)NSEC_PER_SEC;
+}
+
+/* ------------------------------------------------------------------ */
+/* fila de prazos                                                      */
+/* ------------------------------------------------------------------ */
+
+static void place(timer_queue *q, timer_entry *e, int slot)
+{
+    q->heap[slot] = e;
+    e->slot = slot;
+}
+
+static void sift_up(timer_queue *q, int slot)
+{
+    timer_entry *e = q->heap[slot];
+    int parent;
+
+    while (slot > 0 && q->heap[parent = (slot - 1) / 2]->deadline > e->deadline)
+    {
+        place(q, q->heap[parent], slot);
+        slot = parent;
+    }
+
+    place(q, e, slot);
+}
+
+static void sift_down(timer_queue *q, int slot)
+{
+    timer_entry *e = q->heap[slot];
+    int child;
+
+    while ((child = 2 * slot + 1) < q->count)
+    {
+        if (child + 1 < q->count && q->heap[child + 1]->deadline < q->heap[child]->deadline)
+            child++;
+
+        if (q->heap[child]->deadline >= e->deadline)
+            break;
+
+        place(q, q->heap[child], slot);
+        slot = child;
+    }
+
+    place(q, e, slot);
+}
+
+static void rearm(timer_queue *q)
+{ /* arma <fd> para o prazo mais próximo, em tempo absoluto; 0 desarma */
+    struct itimerspec spec = {{0, 0}, {0, 0}};
+    nsec deadline = (q->count > 0)? q->heap[0]->deadline: 0;
+
+    if (deadline == q->armed)
+        return;
+
+    if (deadline > 0)
+    {
+        spec.it_value.tv_sec = deadline / NSEC_PER_SEC;
+        spec.it_value.tv_nsec = deadline % NSEC_PER_SEC;
+    }
+
+    if (timerfd_settime(q->fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0)
+        q->armed = deadline;
+}
+
+int timer_queue_init(timer_queue *q)
+{
+    q->heap = NULL;
+    q->count = q->capacity = 0;
+    q->armed = 0;
+    q->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    return (q->fd == -1)? -1: 0;
+}
+
+void timer_queue_free(timer_queue *q)
+{
+    if (q->fd != -1)
+        close(q->fd);
+
+    for (int i = 0; i < q->count; i++)
+        q->heap[i]->slot = -1;
+
+    free(q->heap);
+    q->heap = NULL;
+    q->count = q->capacity = 0;
+    q->fd = -1;
+}
+
+void timer_entry_init(timer_entry *e)
+{
+    e->deadline = 0;
+    e->slot = -1;
+}
+
+/*
+ *  - PROPÓSITO:
+ *
+ *  Arma <e> para o instante absoluto <deadline> (ver <timer_now()>),
+ *  substituindo o prazo anterior, se houver.
+ *
+ *  - RETORNO:
+ *
+ *  0 em caso de sucesso e -1 se faltar memória para a fila (ENOMEM).
+ */
+
+int timer_set(timer_queue *q, timer_entry *e, nsec deadline)
+{
+    timer_entry **grown;
+    nsec previous = e->deadline;
+
+    if (e->slot == -1)
+    {
+        if (q->count == q->capacity)
+        {
+            if ((grown = realloc(q->heap, (q->capacity? 2 * q->capacity: 64) * sizeof(timer_entry *))) == NULL)
+            {
+                errno = ENOMEM;
+                return -1;
+            }
+
+            q->heap = grown;
+            q->capacity = q->capacity? 2 * q->capacity: 64;
+        }
+
+        e->deadline = deadline;
+        place(q, e, q->count++);
+        sift_up(q, e->slot);
+    }
+    else
+    {
+        e->deadline = deadline;
+
+        if (deadline < previous)
+            sift_up(q, e->slot);
+        else
+            sift_down(q, e->slot);
+    }
+
+    rearm(q);
+
+    return 0;
+}
+
+void timer_cancel(timer_queue *q, timer_entry *e)
+{
+    timer_entry *moved;
+    int slot = e->slot;
+
+    if (slot == -1)
+        return;
+
+    e->slot = -1;
+
+    if (slot < --q->count)
+    { /* a última entrada ocupa o lugar vago e desce ou sobe até se acomodar */
+        moved = q->heap[q->count];
+        place(q, moved, slot);
+        sift_down(q, slot);
+        sift_up(q, moved->slot);
+    }
+
+    rearm(q);
+}
+
+/*
+ *  Retira e devolve uma entrada cujo prazo já passou em <now>, ou NULL se
+ *  não houver; neste caso, o timer é rearmado para o próximo prazo. Deve
+ *  ser chamada em laço até devolver NULL após cada disparo de <fd>.
+ */
+
+timer_entry *timer_expired(timer_queue *q, nsec now)
+{
+    timer_entry *e;
+
+    if (q->count == 0 || q->heap[0]->deadline > now)
+    {
+        rearm(q);
+        return NULL;
+    }
+
+    e = q->heap[0];
+    e->slot = -1;
+
+    if (--q->count > 0)
+    {
+        place(q, q->heap[q->count], 0);
+        sift_down(q, 0);
+    }
+
+    return e;
+}
+
+void timer_acknowledge(timer_queue *q)
+{ /* consome o disparo de <fd>; o timer fica desarmado até o próximo <rearm()> */
+    unsigned long long expirations;
+
+    if (read(q->fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+        q->armed = 0;
+}
@@ -0,0 +1,144 @@
+#include <stddef.h>
+#include <treap.h>
+
+static unsigned priority(int i)
+{ /* prioridade fixa do nó <i>, para não consumir o gerador de nenhuma partida */
+    unsigned x = (unsigned)i * 0x9E3779B1u;
+
+    x ^= x >> 15;
+    x *= 0x85EBCA77u;
+    x ^= x >> 13;
+
+    return x;
+}
+
+static int tree_size(const treap *t, int n)
+{
+    return (n == -1)? 0: t->node[n].size;
+}
+
+static void resize(treap *t, int n)
+{
+    t->node[n].size = 1 + tree_size(t, t->node[n].left) + tree_size(t, t->node[n].right);
+}
+
+static void split(treap *t, int n, int key, int *l, int *r)
+{ /* <l> recebe os nós à frente de <key>, <r> os demais */
+    if (n == -1)
+    {
+        *l = *r = -1;
+        return;
+    }
+
+    if (t->ahead(t->keys, n, key))
+    {
+        split(t, t->node[n].right, key, &t->node[n].right, r);
+        *l = n;
+    }
+    else
+    {
+        split(t, t->node[n].left, key, l, &t->node[n].left);
+        *r = n;
+    }
+
+    resize(t, n);
+}
+
+static int merge(treap *t, int a, int b)
+{ /* todos os nós de <a> vêm antes dos de <b> */
+    if (a == -1)
+        return b;
+    if (b == -1)
+        return a;
+
+    if (priority(a) > priority(b))
+    {
+        t->node[a].right = merge(t, t->node[a].right, b);
+        resize(t, a);
+        return a;
+    }
+
+    t->node[b].left = merge(t, a, t->node[b].left);
+    resize(t, b);
+    return b;
+}
+
+static int erase(treap *t, int n, int i)
+{ /* remove <i> da subárvore <n> */
+    if (n == i)
+        return merge(t, t->node[i].left, t->node[i].right);
+
+    if (t->ahead(t->keys, i, n))
+        t->node[n].left = erase(t, t->node[n].left, i);
+    else
+        t->node[n].right = erase(t, t->node[n].right, i);
+
+    resize(t, n);
+
+    return n;
+}
+
+static void collect(const treap *t, int n, int k, int *out, int *count)
+{
+    if (n == -1 || *count == k)
+        return;
+
+    collect(t, t->node[n].left, k, out, count);
+
+    if (*count < k)
+        out[(*count)++] = n;
+
+    collect(t, t->node[n].right, k, out, count);
+}
+
+void treap_init(treap *t, treap_node *node, treap_order ahead, const void *keys)
+{ /* vazia */
+    t->node = node;
+    t->root = -1;
+    t->ahead = ahead;
+    t->keys = keys;
+}
+
+void treap_insert(treap *t, int i)
+{ /* <i> entra com a chave que tiver agora */
+    int l, r;
+
+    split(t, t->root, i, &l, &r);
+
+    t->node[i].left = t->node[i].right = -1;
+    t->node[i].size = 1;
+
+    t->root = merge(t, merge(t, l, i), r);
+}
+
+void treap_erase(treap *t, int i)
+{ /* <i> deve estar na árvore, com a chave com que entrou */
+    t->root = erase(t, t->root, i);
+}
+
+int treap_rank(const treap *t, int i)
+{ /* posição de <i>, a partir de 1 */
+    int rank = 1, n = t->root;
+
+    while (n != i)
+    {
+        if (t->ahead(t->keys, i, n))
+            n = t->node[n].left;
+        else
+        {
+            rank += tree_size(t, t->node[n].left) + 1;
+            n = t->node[n].right;
+        }
+    }
+
+    return rank + tree_size(t, t->node[i].left);
+}
+
+int treap_top(const treap *t, int k, int *out)
+{ /* os <k> primeiros em <out>, em ordem; retorna quantos são */
+    int count = 0;
+
+    collect(t, t->root, k, out, &count);
+
+    return count;
+}
@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <locale.h>
+#include <wctype.h>
+#include <time.h>
+#include <wstr.h>
+
+/*
+ *  Microbenchmark dos utilitários de <wstr.c>: <$ make bench>, ou
+ *  <$ ./wbench [filtro]> para rodar só as funções cujo nome contenha
+ *  <filtro>. Para cada função e entrada, imprime ns/op e alocações/op.
+ *
+ *  As alocações são contadas substituindo <malloc()> e companhia neste
+ *  executável (a glibc permite), de modo que as feitas internamente pela
+ *  biblioteca, como as de <open_wmemstream()>, também entram na conta.
+ */
+
+#define MIN_TIME 0.05 /* segundos medidos por caso, no mínimo */
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void __libc_free(void *p);
+
+static unsigned long long allocations;
+
+void *malloc(size_t size)
+{
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    allocations++;
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size)
+{
+    allocations++;
+    return __libc_realloc(p, size);
+}
+
+void free(void *p)
+{
+    __libc_free(p);
+}
+
+typedef struct {
+    const wchar_t *name;
+    wchar_t *text;
+    wchar_t *upper; /* mesma entrada em maiúsculas, para <same_str()> */
+} input;
+
+typedef struct {
+    const wchar_t *name;
+    void (*run)(const input *in);
+} bench;
+
+static volatile long long sink; /* impede que o compilador descarte os resultados */
+static arena bench_arena;
+
+static void run_trim(const input *in)
+{
+    wchar_t *s = trim_wstring(NULL, in->text);
+
+    sink += s[0];
+    free(s);
+}
+
+static void run_trim_arena(const input *in)
+{
+    sink += trim_wstring(&bench_arena, in->text)[0];
+    arena_reset(&bench_arena);
+}
+
+static void run_size(const input *in)
+{
+    sink += wstr_size(in->text);
+}
+
+static void run_find(const input *in)
+{ /* caractere ausente: percorre a string inteira */
+    sink += wstr_find(in->text, L'#');
+}
+
+static void run_same(const input *in)
+{
+    sink += same_str(in->text, in->upper);
+}
+
+static void run_starts(const input *in)
+{
+    sink += starts_with(in->text, L'S');
+}
+
+static void run_concat(const input *in)
+{
+    wchar_t *s = concat(in->text, in->text);
+
+    sink += s[0];
+    free(s);
+}
+
+static void run_centered(const input *in)
+{
+    wchar_t *s = centered(in->text, L'-', wstr_size(in->text) + 20);
+
+    sink += s[0];
+    free(s);
+}
+
+static void run_fwstring(const input *in)
+{ /* o prompt de <get_answer()>, com a entrada no lugar do nome */
+    wchar_t *s = fwstring(NULL, L"%S, você tem %s segundo(s) para inserir palavra na categoria \"%S\" começando com \"%C\": ",
+                          in->text, "%.2lf", L"Profissões", L'S');
+
+    sink += s[0];
+    free(s);
+}
+
+static const bench benches[] = {
+    {L"trim_wstring", run_trim},
+    {L"trim_wstring/arena", run_trim_arena},
+    {L"wstr_size", run_size},
+    {L"wstr_find", run_find},
+    {L"same_str", run_same},
+    {L"starts_with", run_starts},
+    {L"concat", run_concat},
+    {L"centered", run_centered},
+    {L"vfwstring", run_fwstring},
+};
+
+static wchar_t *repeat(const wchar_t *piece, int size)
+{ /* <piece> repetido até <size> caracteres */
+    wchar_t *s = malloc((size + 1) * sizeof(wchar_t));
+    int n = wcslen(piece);
+
+    for (int i = 0; i < size; i++)
+        s[i] = piece[i % n];
+
+    s[size] = 0;
+
+    return s;
+}
+
+static wchar_t *upper(const wchar_t *s)
+{
+    wchar_t *u = wcsdup(s);
+
+    for (int i = 0; u[i] != 0; i++)
+        u[i] = towupper(u[i]);
+
+    return u;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static void measure(const bench *b, const input *in)
+{ /* dobra as iterações até o lote levar ao menos MIN_TIME */
+    unsigned long long before;
+    double start, elapsed;
+    long n = 1, i;
+
+    b->run(in); /* aquece caches e a arena */
+
+    for (;;)
+    {
+        before = allocations;
+        start = now();
+
+        for (i = 0; i < n; i++)
+            b->run(in);
+
+        elapsed = now() - start;
+
+        if (elapsed >= MIN_TIME)
+            break;
+
+        n *= 2;
+    }
+
+    wprintf(L"%-20S %-16S %8d %12.1lf %10.2lf\n", b->name, in->name, wstr_size(in->text),
+            elapsed * 1E9 / n, (double)(allocations - before) / n);
+}
+
+int main(int argc, char *argv[])
+{
+    wchar_t filter[64] = L"";
+    input inputs[] = {
+        {L"curta", repeat(L"  Sofia  ", 9), NULL},
+        {L"acentuada", repeat(L"  São  José   dos   Açaís  ", 27), NULL},
+        {L"muitos espaços", repeat(L"S                                                               x", 4096), NULL},
+        {L"colagem longa", repeat(L"Sabiá cantou à beira do riacho, e a canção ecoou pela várzea. ", 65536), NULL},
+    };
+    const int n_inputs = sizeof(inputs) / sizeof(input);
+
+    setlocale(LC_ALL, "");
+
+    if (MB_CUR_MAX == 1)
+        setlocale(LC_CTYPE, "C.UTF-8"); /* <towupper()> de letras acentuadas */
+
+    if (argc > 1)
+        mbstowcs(filter, argv[1], 63);
+
+    for (int i = 0; i < n_inputs; i++)
+        inputs[i].upper = upper(inputs[i].text);
+
+    arena_init(&bench_arena, 0);
+
+    wprintf(L"Núcleos: %s (WSTR_ISA=scalar|sse2|avx2 para forçar)\n\n", wstr_isa());
+    wprintf(L"%-20S %-16S %8S %12S %10S\n", L"função", L"entrada", L"tamanho", L"ns/op", L"alocs/op");
+
+    for (int b = 0; b < sizeof(benches) / sizeof(bench); b++)
+    {
+        if (wcsstr(benches[b].name, filter) == NULL)
+            continue;
+
+        for (int i = 0; i < n_inputs; i++)
+            measure(&benches[b], &inputs[i]);
+    }
+
+    for (int i = 0; i < n_inputs; i++)
+    {
+        free(inputs[i].text);
+        free(inputs[i].upper);
+    }
+
+    arena_free(&bench_arena);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <wctype.h>
+#include <wstr.h>
+
+wchar_t *trim_wstring(arena *a, wchar_t const *s)
+{
+    int i = 0; /* current <s> index */
+    int j;     /* <trimmed> size */
+    int n = wstr_size(s) + 1; /* nunca cresce: aparar só encurta */
+    wchar_t *trimmed = mem_alloc(a, n * WCHAR_SIZE), *temp_trimmed; /* trimmed string */
+
+    if (trimmed != NULL)
+    {
+        /* skip left-hand spaces */
+        while (s[i] == L' ')
+            i++;
+
+        j = wstr_squeeze(trimmed, s + i, n - 1 - i);
+
+        if (j > 0 && trimmed[j - 1] == L' ')
+            j--;
+
+        trimmed[j] = 0;
+
+        temp_trimmed = mem_grow(a, trimmed, n * WCHAR_SIZE, (j + 1) * WCHAR_SIZE);
+
+        if (temp_trimmed != NULL)
+            trimmed = temp_trimmed;
+    }
+
+    return trimmed;
+}
+
+wchar_t *vfwstring(arena *a, const wchar_t *format, va_list ap)
+{ /* formata direto no destino, dobrando-o enquanto <vswprintf()> não couber */
+    size_t size = 64;
+    wchar_t *s = mem_alloc(a, size * WCHAR_SIZE), *grown;
+    va_list aq;
+    int n;
+
+    while (s != NULL)
+    {
+        va_copy(aq, ap);
+        n = vswprintf(s, size, format, aq);
+        va_end(aq);
+
+        if (n >= 0)
+        {
+            grown = mem_grow(a, s, size * WCHAR_SIZE, (n + 1) * WCHAR_SIZE);
+            return (grown == NULL)? s: grown;
+        }
+
+        if (size >= (1 << 20))
+        { /* -1 também indica erro de conversão, que não se resolve crescendo */
+            mem_free(a, s);
+            return NULL;
+        }
+
+        grown = mem_grow(a, s, size * WCHAR_SIZE, 2 * size * WCHAR_SIZE);
+
+        if (grown == NULL)
+            mem_free(a, s);
+
+        s = grown;
+        size *= 2;
+    }
+
+    return NULL;
+}
+
+wchar_t *fwstring(arena *a, const wchar_t *format, ...)
+{
+    wchar_t *s = NULL;
+
+    va_list ap;
+
+    va_start(ap, format);
+
+    s = vfwstring(a, format, ap);
+
+    va_end(ap);
+
+    return s;
+}
+
+/*
+ *  Maiúscula sem diacríticos de cada caractere de Latin-1 e Latin
+ *  Extended-A: "á", "Ã" e "ą" viram "A"; "ç", "C"; "ß" e "ſ", "S"; letras
+ *  sem forma base (Æ, Œ, Þ...) só passam a maiúsculas, e o que não é letra
+ *  fica como está.
+ */
+
+const unsigned short fold_table[FOLD_TABLE_SIZE] = {
+    /* 0x0000 */ 0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, 0x000F,
+    /* 0x0010 */ 0x0010, 0x0011, 0x0012, 0x0013, 0x0014, 0x0015, 0x0016, 0x0017, 0x0018, 0x0019, 0x001A, 0x001B, 0x001C, 0x001D, 0x001E, 0x001F,
+    /* 0x0020 */ 0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+    /* 0x0030 */ 0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+    /* 0x0040 */ 0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+    /* 0x0050 */ 0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x005B, 0x005C, 0x005D, 0x005E, 0x005F,
+    /* 0x0060 */ 0x0060, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+    /* 0x0070 */ 0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x007B, 0x007C, 0x007D, 0x007E, 0x007F,
+    /* 0x0080 */ 0x0080, 0x0081, 0x0082, 0x0083, 0x0084, 0x0085, 0x0086, 0x0087, 0x0088, 0x0089, 0x008A, 0x008B, 0x008C, 0x008D, 0x008E, 0x008F,
+    /* 0x0090 */ 0x0090, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095, 0x0096, 0x0097, 0x0098, 0x0099, 0x009A, 0x009B, 0x009C, 0x009D, 0x009E, 0x009F,
+    /* 0x00A0 */ 0x00A0, 0x00A1, 0x00A2, 0x00A3, 0x00A4, 0x00A5, 0x00A6, 0x00A7, 0x00A8, 0x00A9, 0x00AA, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x00AF,
+    /* 0x00B0 */ 0x00B0, 0x00B1, 0x00B2, 0x00B3, 0x00B4, 0x00B5, 0x00B6, 0x00B7, 0x00B8, 0x00B9, 0x00BA, 0x00BB, 0x00BC, 0x00BD, 0x00BE, 0x00BF,
+    /* 0x00C0 */ 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x00C6, 0x0043, 0x0045, 0x0045, 0x0045, 0x0045, 0x0049, 0x0049, 0x0049, 0x0049,
+    /* 0x00D0 */ 0x00D0, 0x004E, 0x004F, 0x004F, 0x004F, 0x004F, 0x004F, 0x00D7, 0x004F, 0x0055, 0x0055, 0x0055, 0x0055, 0x0059, 0x00DE, 0x0053,
+    /* 0x00E0 */ 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x00C6, 0x0043, 0x0045, 0x0045, 0x0045, 0x0045, 0x0049, 0x0049, 0x0049, 0x0049,
+    /* 0x00F0 */ 0x00D0, 0x004E, 0x004F, 0x004F, 0x004F, 0x004F, 0x004F, 0x00F7, 0x004F, 0x0055, 0x0055, 0x0055, 0x0055, 0x0059, 0x00DE, 0x0059,
+    /* 0x0100 */ 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0043, 0x0043, 0x0043, 0x0043, 0x0043, 0x0043, 0x0043, 0x0043, 0x0044, 0x0044,
+    /* 0x0110 */ 0x0044, 0x0044, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045, 0x0047, 0x0047, 0x0047, 0x0047,
+    /* 0x0120 */ 0x0047, 0x0047, 0x0047, 0x0047, 0x0048, 0x0048, 0x0048, 0x0048, 0x0049, 0x0049, 0x0049, 0x0049, 0x0049, 0x0049, 0x0049, 0x0049,
+    /* 0x0130 */ 0x0049, 0x0049, 0x0132, 0x0132, 0x004A, 0x004A, 0x004B, 0x004B, 0x0138, 0x004C, 0x004C, 0x004C, 0x004C, 0x004C, 0x004C, 0x004C,
+    /* 0x0140 */ 0x004C, 0x004C, 0x004C, 0x004E, 0x004E, 0x004E, 0x004E, 0x004E, 0x004E, 0x004E, 0x014A, 0x014A, 0x004F, 0x004F, 0x004F, 0x004F,
+    /* 0x0150 */ 0x004F, 0x004F, 0x0152, 0x0152, 0x0052, 0x0052, 0x0052, 0x0052, 0x0052, 0x0052, 0x0053, 0x0053, 0x0053, 0x0053, 0x0053, 0x0053,
+    /* 0x0160 */ 0x0053, 0x0053, 0x0054, 0x0054, 0x0054, 0x0054, 0x0054, 0x0054, 0x0055, 0x0055, 0x0055, 0x0055, 0x0055, 0x0055, 0x0055, 0x0055,
+    /* 0x0170 */ 0x0055, 0x0055, 0x0055, 0x0055, 0x0057, 0x0057, 0x0059, 0x0059, 0x0059, 0x005A, 0x005A, 0x005A, 0x005A, 0x005A, 0x005A, 0x0053,
+};
+
+int starts_with(wchar_t *s, wchar_t l)
+{ /* -1 se <l> não for letra de A a Z, ainda que acentuada */
+    wchar_t letter = fold_char(l);
+
+    if (letter < L'A' || letter > L'Z')
+        return -1;
+
+    return fold_char(s[0]) == letter;
+}
+
+int fconcat(FILE *stream, wchar_t *start, wchar_t *end)
+{
+    if (fputws(start, stream) == -1)
+        return -1;
+    if (fputws(end, stream) == -1)
+        return -1;
+    return 1;
+}
+
+wchar_t *concat(wchar_t *start, wchar_t *end)
+{
+    wchar_t *buffer;
+    size_t len;
+    FILE *mem_stream = open_wmemstream(&buffer, &len);
+
+    int n = fconcat(mem_stream, start, end);
+
+    fclose(mem_stream);
+
+    if (n == -1)
+    {
+        free(buffer);
+        buffer = NULL;
+    }
+
+    return buffer;
+}
+
+void fcentered(FILE *stream, wchar_t *s, wchar_t placeholder, int field_width)
+{
+    int i, str_len = wstr_size(s);
+
+    int remaining_length = (field_width - str_len);
+
+    if (remaining_length <= 0)
+        remaining_length = 0;
+
+    for (i = 0; i < remaining_length / 2; i++)
+        putwc(placeholder, stream);
+
+    for (i = 0; i < str_len; i++)
+        putwc(s[i], stream);
+
+    for (i = 0; i < remaining_length - remaining_length / 2; i++)
+        putwc(placeholder, stream);
+}
+
+wchar_t *centered(wchar_t *s, wchar_t placeholder, int field_width)
+{
+    wchar_t *buffer;
+    size_t len;
+    FILE *mem_stream = open_wmemstream(&buffer, &len);
+
+    int str_len = wstr_size(s);
+
+    int remaining_length = (field_width - str_len), i;
+
+    if (remaining_length <= 0)
+        remaining_length = 0;
+
+    for (i = 0; i < remaining_length / 2; i++)
+        putwc(placeholder, mem_stream);
+
+    for (i = 0; i < str_len; i++)
+        putwc(s[i], mem_stream);
+
+    fflush(mem_stream); /* required to <len> stay up to date */
+
+    for (i = len; i < field_width; i++)
+        putwc(placeholder, mem_stream);
+
+    fclose(mem_stream);
+
+    return buffer;
+}
+
+void frepeat(FILE *stream, wchar_t *r, wchar_t *sep, int n)
+{
+
+    for (int i = 0; i < n - 1; i++)
+    {
+        fputws(r, stream);
+        if (sep != NULL) fputws(sep, stream);
+    }
+
+    fputws(r, stream);
+}
+
+int max_str(wchar_t const * const*S, int n)
+{
+
+    int max_len = 0, size;
+
+    for (int i = 0; i < n; i++)
+    {
+        size = wstr_size(S[i]);
+
+        if (size > max_len)
+            max_len = size;
+    }
+
+    return max_len;
+}
+
+int same_str(wchar_t *a, wchar_t *b) {
+    int l = wstr_size(a);
+    if (l != wstr_size(b)) return 0;
+
+    return wstr_same_folded(a, b, l); /* mesma letra segundo <fold_char()> */
+}
@@ -0,0 +1,369 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <wstr.h>
+
+/*
+ *  Núcleos vetoriais de <wstr.c>, com versões escalar, SSE2 e AVX2. A
+ *  versão é escolhida uma única vez, antes de <main()>, conforme a CPU;
+ *  a variável de ambiente WSTR_ISA (scalar, sse2 ou avx2) força uma delas,
+ *  se suportada, para comparações em <wbench>.
+ *
+ *  As buscas pelo terminador leem blocos alinhados, que podem ir além do
+ *  fim da string mas nunca cruzam uma página, e por isso não são
+ *  instrumentadas pelo AddressSanitizer.
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WSTR_X86 1
+#include <immintrin.h>
+#endif
+
+#define NO_ASAN __attribute__((no_sanitize_address))
+
+typedef struct {
+    const char *name;
+    int (*size)(wchar_t const *s);
+    int (*find)(wchar_t const *s, wchar_t c);
+    int (*squeeze)(wchar_t *dst, wchar_t const *src, int n);
+    int (*same_folded)(wchar_t const *a, wchar_t const *b, int n);
+} kernels;
+
+/* ------------------------------------------------------------------ */
+/* escalar                                                             */
+/* ------------------------------------------------------------------ */
+
+static int size_scalar(wchar_t const *s)
+{
+    int i = 0;
+
+    while (s[i] != 0)
+        i++;
+
+    return i;
+}
+
+static int find_scalar(wchar_t const *s, wchar_t c)
+{
+    int i = 0;
+
+    while (s[i] != 0 && s[i] != c)
+        i++;
+
+    if (s[i] == 0)
+        i = -1;
+
+    return i;
+}
+
+static int squeeze_tail(wchar_t *dst, int j, wchar_t const *src, int i, int n, int prev_space)
+{ /* colapsa espaços de <src>[i, n) em <dst> a partir de <j> */
+    for (; i < n; i++)
+    {
+        if (src[i] != L' ' || !prev_space)
+            dst[j++] = src[i];
+
+        prev_space = (src[i] == L' ');
+    }
+
+    return j;
+}
+
+static int squeeze_scalar(wchar_t *dst, wchar_t const *src, int n)
+{
+    return squeeze_tail(dst, 0, src, 0, n, 0);
+}
+
+static int same_folded_tail(wchar_t const *a, wchar_t const *b, int i, int n)
+{
+    for (; i < n; i++)
+        if (a[i] != b[i] && fold_char(a[i]) != fold_char(b[i]))
+            return 0;
+
+    return 1;
+}
+
+static int same_folded_scalar(wchar_t const *a, wchar_t const *b, int n)
+{
+    return same_folded_tail(a, b, 0, n);
+}
+
+static const kernels scalar = {"scalar", size_scalar, find_scalar, squeeze_scalar, same_folded_scalar};
+
+#ifdef WSTR_X86
+
+/* ------------------------------------------------------------------ */
+/* SSE2: 4 caracteres por vetor                                        */
+/* ------------------------------------------------------------------ */
+
+__attribute__((target("sse2"))) NO_ASAN
+static int size_sse2(wchar_t const *s)
+{
+    const wchar_t *p = s;
+    __m128i zero = _mm_setzero_si128();
+    int mask;
+
+    for (; (uintptr_t)p & 15; p++)
+        if (*p == 0)
+            return p - s;
+
+    for (;; p += 4)
+    {
+        mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_load_si128((const __m128i *)p), zero)));
+
+        if (mask != 0)
+            return p - s + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("sse2"))) NO_ASAN
+static int find_sse2(wchar_t const *s, wchar_t c)
+{
+    const wchar_t *p = s;
+    __m128i zero = _mm_setzero_si128(), wanted = _mm_set1_epi32(c), v;
+    int mask;
+
+    if (c == 0)
+        return -1;
+
+    for (; (uintptr_t)p & 15; p++)
+        if (*p == 0 || *p == c)
+            return (*p == 0)? -1: p - s;
+
+    for (;; p += 4)
+    {
+        v = _mm_load_si128((const __m128i *)p);
+        mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(v, zero), _mm_cmpeq_epi32(v, wanted))));
+
+        if (mask != 0)
+        {
+            p += __builtin_ctz(mask);
+            return (*p == 0)? -1: p - s;
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+static int squeeze_sse2(wchar_t *dst, wchar_t const *src, int n)
+{ /* blocos sem espaço repetido são copiados inteiros, e os só de repetidos, pulados */
+    __m128i spaces = _mm_set1_epi32(L' '), v;
+    int i, j = 0, k, space, drop, carry = 0;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        v = _mm_loadu_si128((const __m128i *)(src + i));
+        space = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, spaces)));
+        drop = space & ((space << 1) | carry) & 0xF;
+
+        if (drop == 0)
+        {
+            _mm_storeu_si128((__m128i *)(dst + j), v);
+            j += 4;
+        }
+        else if (drop != 0xF)
+        {
+            for (k = 0; k < 4; k++)
+                if (!(drop & (1 << k)))
+                    dst[j++] = src[i + k];
+        }
+
+        carry = space >> 3;
+    }
+
+    return squeeze_tail(dst, j, src, i, n, carry);
+}
+
+__attribute__((target("sse2")))
+static __m128i upper_ascii_sse2(__m128i v)
+{ /* 'a'..'z' -> 'A'..'Z'; demais caracteres inalterados */
+    __m128i lower = _mm_and_si128(_mm_cmpgt_epi32(v, _mm_set1_epi32(L'a' - 1)), _mm_cmplt_epi32(v, _mm_set1_epi32(L'z' + 1)));
+
+    return _mm_sub_epi32(v, _mm_and_si128(lower, _mm_set1_epi32(0x20)));
+}
+
+__attribute__((target("sse2")))
+static int same_folded_sse2(wchar_t const *a, wchar_t const *b, int n)
+{ /* só os blocos que diferem além da caixa ASCII recorrem a <fold_char()> */
+    __m128i va, vb;
+    int i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        va = _mm_loadu_si128((const __m128i *)(a + i));
+        vb = _mm_loadu_si128((const __m128i *)(b + i));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(upper_ascii_sse2(va), upper_ascii_sse2(vb))) != 0xFFFF &&
+            !same_folded_tail(a, b, i, i + 4))
+            return 0;
+    }
+
+    return same_folded_tail(a, b, i, n);
+}
+
+static const kernels sse2 = {"sse2", size_sse2, find_sse2, squeeze_sse2, same_folded_sse2};
+
+/* ------------------------------------------------------------------ */
+/* AVX2: 8 caracteres por vetor                                        */
+/* ------------------------------------------------------------------ */
+
+__attribute__((target("avx2"))) NO_ASAN
+static int size_avx2(wchar_t const *s)
+{
+    const wchar_t *p = s;
+    __m256i zero = _mm256_setzero_si256();
+    int mask;
+
+    for (; (uintptr_t)p & 31; p++)
+        if (*p == 0)
+            return p - s;
+
+    for (;; p += 8)
+    {
+        mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_load_si256((const __m256i *)p), zero)));
+
+        if (mask != 0)
+            return p - s + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("avx2"))) NO_ASAN
+static int find_avx2(wchar_t const *s, wchar_t c)
+{
+    const wchar_t *p = s;
+    __m256i zero = _mm256_setzero_si256(), wanted = _mm256_set1_epi32(c), v;
+    int mask;
+
+    if (c == 0)
+        return -1;
+
+    for (; (uintptr_t)p & 31; p++)
+        if (*p == 0 || *p == c)
+            return (*p == 0)? -1: p - s;
+
+    for (;; p += 8)
+    {
+        v = _mm256_load_si256((const __m256i *)p);
+        mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(v, zero), _mm256_cmpeq_epi32(v, wanted))));
+
+        if (mask != 0)
+        {
+            p += __builtin_ctz(mask);
+            return (*p == 0)? -1: p - s;
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static int squeeze_avx2(wchar_t *dst, wchar_t const *src, int n)
+{
+    __m256i spaces = _mm256_set1_epi32(L' '), v;
+    int i, j = 0, k, space, drop, carry = 0;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        v = _mm256_loadu_si256((const __m256i *)(src + i));
+        space = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, spaces)));
+        drop = space & ((space << 1) | carry) & 0xFF;
+
+        if (drop == 0)
+        {
+            _mm256_storeu_si256((__m256i *)(dst + j), v);
+            j += 8;
+        }
+        else if (drop != 0xFF)
+        {
+            for (k = 0; k < 8; k++)
+                if (!(drop & (1 << k)))
+                    dst[j++] = src[i + k];
+        }
+
+        carry = space >> 7;
+    }
+
+    return squeeze_tail(dst, j, src, i, n, carry);
+}
+
+__attribute__((target("avx2")))
+static __m256i upper_ascii_avx2(__m256i v)
+{
+    __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi32(v, _mm256_set1_epi32(L'a' - 1)), _mm256_cmpgt_epi32(_mm256_set1_epi32(L'z' + 1), v));
+
+    return _mm256_sub_epi32(v, _mm256_and_si256(lower, _mm256_set1_epi32(0x20)));
+}
+
+__attribute__((target("avx2")))
+static int same_folded_avx2(wchar_t const *a, wchar_t const *b, int n)
+{
+    __m256i va, vb;
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        va = _mm256_loadu_si256((const __m256i *)(a + i));
+        vb = _mm256_loadu_si256((const __m256i *)(b + i));
+
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(upper_ascii_avx2(va), upper_ascii_avx2(vb))) != -1 &&
+            !same_folded_tail(a, b, i, i + 8))
+            return 0;
+    }
+
+    return same_folded_tail(a, b, i, n);
+}
+
+static const kernels avx2 = {"avx2", size_avx2, find_avx2, squeeze_avx2, same_folded_avx2};
+
+#endif
+
+static const kernels *isa = &scalar;
+
+__attribute__((constructor))
+static void choose_kernels(void)
+{
+    const kernels *best = &scalar, *wanted = NULL;
+    const char *env = getenv("WSTR_ISA");
+
+#ifdef WSTR_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse2"))
+        best = &sse2;
+
+    if (__builtin_cpu_supports("avx2"))
+        best = &avx2;
+
+    if (env != NULL && strcmp(env, "sse2") == 0 && __builtin_cpu_supports("sse2"))
+        wanted = &sse2;
+    else if (env != NULL && strcmp(env, "avx2") == 0 && __builtin_cpu_supports("avx2"))
+        wanted = &avx2;
+#endif
+
+    if (env != NULL && strcmp(env, "scalar") == 0)
+        wanted = &scalar;
+
+    isa = (wanted != NULL)? wanted: best;
+}
+
+const char *wstr_isa(void)
+{
+    return isa->name;
+}
+
+int wstr_size(wchar_t const *s)
+{
+    return isa->size(s);
+}
+
+int wstr_find(wchar_t const *s, wchar_t c)
+{
+    return isa->find(s, c);
+}
+
+int wstr_squeeze(wchar_t *dst, wchar_t const *src, int n)
+{
+    return isa->squeeze(dst, src, n);
+}
+
+int wstr_same_folded(wchar_t const *a, wchar_t const *b, int n)
+{
+    return isa->same_folded(a, b, n);
+}